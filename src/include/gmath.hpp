@@ -2,10 +2,16 @@
 #define G_MATH_HPP
 
 #include <xmmintrin.h>
+#include <emmintrin.h>
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <math.h>
 #include <string>
+#include <vector>
 
 #define SHUFFLE_PARAM(x, y, z, w) \
 	((x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
@@ -18,7 +24,47 @@
 #define _mm_replicate_w_ps(v) \
 	_mm_shuffle_ps((v), (v), _MM_SHUFFLE(3, 3, 3, 3))
 
+// GMATH_TRACE_ZONE(name) records the rest of the enclosing scope as a trace zone named by the
+// string literal name. Zones compile to nothing unless GMATH_TRACE is defined.
+#define GMATH_TRACE_CONCAT_(a, b) a##b
+#define GMATH_TRACE_CONCAT(a, b) GMATH_TRACE_CONCAT_(a, b)
+#ifdef GMATH_TRACE
+#define GMATH_TRACE_ZONE(name) \
+	gmath::traceZone GMATH_TRACE_CONCAT(traceZone, __LINE__)(name)
+#else
+#define GMATH_TRACE_ZONE(name)
+#endif
+
 namespace gmath {
+	class vec4_view;
+	class quat_view;
+	class dualquat_view;
+	template <typename View> class strided_span;
+	typedef strided_span<vec4_view> vec4_span;
+	typedef strided_span<quat_view> quat_span;
+	typedef strided_span<dualquat_view> dualquat_span;
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//														trig
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	enum class trigAccuracy {
+		// within about 1 ulp of the correctly rounded result for |x| < 8192
+		precise,
+		// absolute error below 1e-4, fewer reduction and polynomial terms
+		fast
+	};
+
+	class trig {
+	public:
+		// computes sin and cos of all four lanes of x at once
+		static void sincos(const __m128& x, __m128& s, __m128& c, const trigAccuracy& accuracy = trigAccuracy::precise);
+		// computes sin and cos of count floats, arrays may be unaligned
+		static void sincos(const float* x, float* s, float* c, const size_t& count, const trigAccuracy& accuracy = trigAccuracy::precise);
+		// asin and acos of all four lanes, inputs in [-1, 1], within 3 ulp
+		static __m128 asin(const __m128& x);
+		static __m128 acos(const __m128& x);
+	};
+
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	//														vec4
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -29,6 +75,7 @@ namespace gmath {
 		vec4(const float& x = 0.0f, const float& y = 0.0f, const float& z = 0.0f, const float& w = 0.0f);
 		vec4(const __m128& data);
 		vec4(const vec4& other);
+		explicit vec4(const vec4_view& other);
 		vec4(vec4&& other);
 		~vec4();
 
@@ -81,9 +128,13 @@ namespace gmath {
 		static mat rotateZ(const float& radians);
 		static mat rotate(const vec4& a, const float& radians);
 		static mat transform(const vec4& a, const float& radians, const vec4& t);
+
+		// writes m * in[i] to out[i], in and out may alias
+		void transform(const vec4_span& in, const vec4_span& out) const;
 	};
 
 	vec4 operator*(const mat& m, const vec4& v);
+	vec4 operator*(const mat& m, const vec4_view& v);
 	mat operator*(const mat& m1, const mat& m2);
 	mat operator*(const float& s, const mat& m);
 	mat operator*(const mat& m, const float& s);
@@ -107,6 +158,7 @@ namespace gmath {
 		quat(const __m128& data);
 		quat(const vec4& v);
 		quat(const quat& other);
+		explicit quat(const quat_view& other);
 		quat(quat&& other);
 		~quat();
 
@@ -121,7 +173,18 @@ namespace gmath {
 		quat normalize() const;
 		vec4 transform(const vec4& v) const;
 		vec4 transform(const vec4& v, const vec4& t) const;
+		vec4 transform(const vec4_view& v) const;
+		// rotates the xyz of every in[i] into out[i] keeping w, in and out may alias
+		void transform(const vec4_span& in, const vec4_span& out) const;
 		std::string toString() const;
+
+		// hamilton product of two quaternions held in registers as (real, i, j, k)
+		static __m128 multiply(const __m128& q1, const __m128& q2);
+
+		// builds count rotations of radians[i] about the unit axis axes[i]
+		static void fromAxisAngle(const vec4* axes, const float* radians, quat* out, const size_t& count, const trigAccuracy& accuracy = trigAccuracy::precise);
+		// builds count rotations from euler angles (x, y, z) in radians, applied about x first, then y, then z
+		static void fromEuler(const vec4* angles, quat* out, const size_t& count, const trigAccuracy& accuracy = trigAccuracy::precise);
 	};
 
 	quat operator*(const quat& q1, const quat& q2);
@@ -144,6 +207,7 @@ namespace gmath {
 		dualquat(const vec4& v);
 		dualquat(const quat& r, const vec4& t);
 		dualquat(const dualquat& other);
+		explicit dualquat(const dualquat_view& other);
 		dualquat(dualquat&& other);
 		~dualquat();
 
@@ -154,8 +218,15 @@ namespace gmath {
 		dualquat conjugate() const;
 		dualquat dualConjugate() const;
 		dualquat inverse() const;
+		dualquat normalize() const;
 		vec4 transform(const vec4& v) const;
+		vec4 transform(const vec4_view& v) const;
+		// transforms every in[i] into out[i], translating only when w is non zero, in and out may alias
+		void transform(const vec4_span& in, const vec4_span& out) const;
 		std::string toString() const;
+
+		// builds count rigid transforms rotating radians[i] about the unit axis axes[i], then translating by translations[i]
+		static void fromAxisAngle(const vec4* axes, const float* radians, const vec4* translations, dualquat* out, const size_t& count, const trigAccuracy& accuracy = trigAccuracy::precise);
 	};
 
 	dualquat operator*(const dualquat& d1, const dualquat& d2);
@@ -163,6 +234,1259 @@ namespace gmath {
 	dualquat operator*(const dualquat& d, const float& s);
 	dualquat operator+(const dualquat& d1, const dualquat& d2);
 	dualquat operator-(const dualquat& d1, const dualquat& d2);
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//														unit_quat
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// A quat known to have norm 1. The only public way in is a normalizing constructor, so the
+	// overloads below can invert by conjugation and rotate without dividing. Products of unit
+	// quats are unit quats. The quat base is private so the components can't be written through
+	// data, operator[] or a quat reference; toQuat() copies out for the general quat code.
+	class unit_quat : private quat {
+	public:
+		unit_quat();
+		explicit unit_quat(const quat& q);
+		unit_quat(const unit_quat& other);
+		unit_quat(unit_quat&& other);
+
+		unit_quat& operator=(const unit_quat& other);
+		unit_quat& operator=(unit_quat&& other);
+		float operator[](const uint32_t& i) const;
+		unit_quat operator-() const;
+
+		using quat::norm;
+		using quat::toString;
+		using quat::transform;
+		quat toQuat() const;
+		unit_quat conjugate() const;
+		unit_quat inverse() const;
+		vec4 transform(const vec4& v) const;
+		vec4 transform(const vec4& v, const vec4& t) const;
+
+		// axis does not need to be unit length
+		static unit_quat fromAxisAngle(const vec4& axis, const float& radians);
+		// rotates v (x, y, z, w) by unit quaternion q (real, i, j, k), w is kept
+		static __m128 rotate(const __m128& q, const __m128& v);
+
+	private:
+		friend unit_quat operator*(const unit_quat& q1, const unit_quat& q2);
+		friend class unit_dualquat;
+
+		// for results that are unit by construction, skips normalizing
+		struct trusted {};
+		unit_quat(const __m128& q, trusted);
+	};
+
+	unit_quat operator*(const unit_quat& q1, const unit_quat& q2);
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//														unit_dualquat
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// A dualquat known to be a rigid transform: unit rotation component, dual component
+	// orthogonal to it. Inverse is the conjugate and products stay unit_dualquats. The dualquat
+	// base is private for the same reason as unit_quat's, toDualquat() copies out.
+	class unit_dualquat : private dualquat {
+	public:
+		unit_dualquat();
+		explicit unit_dualquat(const dualquat& d);
+		unit_dualquat(const unit_quat& r);
+		unit_dualquat(const unit_quat& r, const vec4& t);
+		unit_dualquat(const unit_dualquat& other);
+		unit_dualquat(unit_dualquat&& other);
+
+		unit_dualquat& operator=(const unit_dualquat& other);
+		unit_dualquat& operator=(unit_dualquat&& other);
+
+		using dualquat::toString;
+		using dualquat::transform;
+		dualquat toDualquat() const;
+		unit_dualquat conjugate() const;
+		unit_dualquat inverse() const;
+		vec4 transform(const vec4& v) const;
+
+		unit_quat rotation() const;
+		vec4 translation() const;
+
+	private:
+		friend unit_dualquat operator*(const unit_dualquat& d1, const unit_dualquat& d2);
+
+		struct trusted {};
+		unit_dualquat(const quat& real, const quat& dual, trusted);
+	};
+
+	unit_dualquat operator*(const unit_dualquat& d1, const unit_dualquat& d2);
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//														rigid
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Rigid transforms tagged with what they can hold. Composition is overloaded on the tags so
+	// the cheapest product is picked at compile time, e.g. translation * translation is a vector
+	// add and rotation * translation is one rotated vector. a * b applies b first, as with dualquat.
+	struct rotation_only {};
+	struct translation_only {};
+	struct general_motion {};
+
+	template <typename Tag> class rigid;
+
+	template <>
+	class rigid<rotation_only> {
+	public:
+		unit_quat r;
+
+		rigid(const unit_quat& r = unit_quat());
+
+		rigid inverse() const;
+		vec4 transform(const vec4& v) const;
+		dualquat toDualquat() const;
+		mat toMat() const;
+	};
+
+	template <>
+	class rigid<translation_only> {
+	public:
+		// w is always 0
+		vec4 t;
+
+		rigid(const vec4& t = vec4());
+
+		rigid inverse() const;
+		vec4 transform(const vec4& v) const;
+		dualquat toDualquat() const;
+		mat toMat() const;
+	};
+
+	template <>
+	class rigid<general_motion> {
+	public:
+		// rotate by r, then translate by t
+		unit_quat r;
+		vec4 t;
+
+		rigid(const unit_quat& r = unit_quat(), const vec4& t = vec4());
+		rigid(const rigid<rotation_only>& other);
+		rigid(const rigid<translation_only>& other);
+		explicit rigid(const unit_dualquat& d);
+
+		rigid inverse() const;
+		vec4 transform(const vec4& v) const;
+		dualquat toDualquat() const;
+		mat toMat() const;
+	};
+
+	typedef rigid<rotation_only> rotation;
+	typedef rigid<translation_only> translation;
+	typedef rigid<general_motion> rigid_motion;
+
+	rotation operator*(const rotation& a, const rotation& b);
+	translation operator*(const translation& a, const translation& b);
+	rigid_motion operator*(const rotation& a, const translation& b);
+	rigid_motion operator*(const translation& a, const rotation& b);
+	rigid_motion operator*(const rigid_motion& a, const rotation& b);
+	rigid_motion operator*(const rotation& a, const rigid_motion& b);
+	rigid_motion operator*(const rigid_motion& a, const translation& b);
+	rigid_motion operator*(const translation& a, const rigid_motion& b);
+	rigid_motion operator*(const rigid_motion& a, const rigid_motion& b);
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//														transform chain
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Records a chain of translations and rotations, each applied after the steps before it, and
+	// collapses it into one transform. Steps are merged as they are recorded: adjacent translations
+	// add, adjacent rotations about the same axis add their angles, and steps that cancel out are
+	// dropped. Runs of rotations are composed as quaternions before touching the translation.
+	//
+	//	const dualquat d = transformChain().translate(vec4(3.0f, 4.0f, 5.0f)).rotateY(a).toDualquat();
+	class transformChain {
+	public:
+		transformChain& translate(const vec4& t);
+		transformChain& rotateX(const float& radians);
+		transformChain& rotateY(const float& radians);
+		transformChain& rotateZ(const float& radians);
+		// axis does not need to be unit length
+		transformChain& rotate(const vec4& axis, const float& radians);
+		// euler angles (x, y, z) in radians, applied about x first, then y, then z
+		transformChain& euler(const vec4& radians);
+
+		// steps left after merging
+		size_t size() const;
+		// hash of the recorded steps, equal chains hash equal
+		uint64_t hash() const;
+
+		rigid_motion toRigid() const;
+		dualquat toDualquat() const;
+		mat toMat() const;
+
+		// same as above, looked up by hash in a cache shared by all threads so that a chain is
+		// only collapsed the first time it is seen. The cache holds at most cacheCapacity chains,
+		// it is emptied whenever a new chain would go past that.
+		rigid_motion cachedRigid() const;
+		dualquat cachedDualquat() const;
+		mat cachedMat() const;
+
+		static const size_t cacheCapacity = 4096;
+		static size_t cacheSize();
+		static void clearCache();
+
+	private:
+		struct step {
+			// translation: (x, y, z, 0), rotation: unit axis and angle in radians
+			float data[4];
+			bool rotation;
+
+			bool operator==(const step& other) const;
+		};
+
+		void append(const step& s);
+
+		std::vector<step> steps;
+	};
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//														views
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Views alias caller owned memory instead of allocating. They behave like references:
+	// copying a view aliases the same memory, assigning to a view writes through to it.
+	// Memory does not need to be 16 byte aligned, views fall back to unaligned loads and stores.
+	class vec4_view {
+	public:
+		float* data = nullptr;
+		bool aligned = false;
+
+		vec4_view(float* data);
+		vec4_view(const vec4& v);
+		vec4_view(const vec4_view& other) = default;
+
+		vec4_view& operator=(const vec4_view& other);
+		vec4_view& operator=(const vec4& other);
+		float& operator[](const uint32_t& i) const;
+		vec4 operator-() const;
+
+		__m128 load() const;
+		void store(const __m128& v) const;
+
+		float dot(const vec4_view& other) const;
+		float magnitude() const;
+		float magnitude2() const;
+		vec4 multiply(const vec4_view& other) const;
+		vec4 normalize() const;
+		std::string toString() const;
+	};
+
+	vec4 operator*(const vec4_view& v1, const vec4_view& v2);
+	vec4 operator*(const float& s, const vec4_view& v);
+	vec4 operator*(const vec4_view& v, const float& s);
+	vec4 operator/(const vec4_view& v, const float& s);
+	vec4 operator+(const vec4_view& v1, const vec4_view& v2);
+	vec4 operator-(const vec4_view& v1, const vec4_view& v2);
+
+	class quat_view {
+	public:
+		// same layout as quat, real component first
+		float* data = nullptr;
+		bool aligned = false;
+
+		quat_view(float* data);
+		quat_view(const quat& q);
+		quat_view(const quat_view& other) = default;
+
+		quat_view& operator=(const quat_view& other);
+		quat_view& operator=(const quat& other);
+		float& operator[](const uint32_t& i) const;
+		quat operator-() const;
+
+		__m128 load() const;
+		void store(const __m128& q) const;
+
+		quat conjugate() const;
+		float norm() const;
+		quat inverse() const;
+		quat normalize() const;
+		vec4 transform(const vec4_view& v) const;
+		vec4 transform(const vec4_view& v, const vec4_view& t) const;
+		std::string toString() const;
+	};
+
+	quat operator*(const quat_view& q1, const quat_view& q2);
+	quat operator*(const float& s, const quat_view& q);
+	quat operator*(const quat_view& q, const float& s);
+	quat operator/(const quat_view& q, const float& s);
+	quat operator+(const quat_view& q1, const quat_view& q2);
+	quat operator-(const quat_view& q1, const quat_view& q2);
+
+	class dualquat_view {
+	public:
+		// [0] rotation component
+		// [1] dual component
+		quat_view data[2];
+
+		// views 8 contiguous floats, rotation component first
+		dualquat_view(float* data);
+		dualquat_view(float* real, float* dual);
+		dualquat_view(const dualquat& d);
+		dualquat_view(const dualquat_view& other) = default;
+
+		dualquat_view& operator=(const dualquat_view& other);
+		dualquat_view& operator=(const dualquat& other);
+		quat_view operator[](const uint32_t i) const;
+
+		dualquat conjugate() const;
+		dualquat dualConjugate() const;
+		dualquat inverse() const;
+		dualquat normalize() const;
+		vec4 transform(const vec4_view& v) const;
+		std::string toString() const;
+	};
+
+	dualquat operator*(const dualquat_view& d1, const dualquat_view& d2);
+	dualquat operator*(const float& s, const dualquat_view& d);
+	dualquat operator*(const dualquat_view& d, const float& s);
+	dualquat operator+(const dualquat_view& d1, const dualquat_view& d2);
+	dualquat operator-(const dualquat_view& d1, const dualquat_view& d2);
+
+	// count views spaced stride bytes apart starting at base, e.g. the positions of an
+	// interleaved vertex buffer. Spans are cheap to copy and never own their memory.
+	template <typename View>
+	class strided_span {
+	public:
+		unsigned char* base = nullptr;
+		size_t count = 0;
+		size_t stride = 0;
+
+		strided_span(void* base, const size_t& count, const size_t& stride):
+			base(static_cast<unsigned char*>(base)), count(count), stride(stride) {
+		}
+
+		View operator[](const size_t& i) const {
+			return View(reinterpret_cast<float*>(base + i * stride));
+		}
+
+		size_t size() const {
+			return count;
+		}
+
+		// true when every element can use aligned loads
+		bool aligned() const {
+			return (reinterpret_cast<uintptr_t>(base) & 15) == 0 && (stride & 15) == 0;
+		}
+
+		strided_span subspan(const size_t& offset, const size_t& length) const {
+			return strided_span(base + offset * stride, length, stride);
+		}
+	};
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//														soa
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Structure of arrays descriptors, one caller owned array per component. Batch kernels
+	// process four consecutive entries per step in quat4 / dualquat4 registers.
+	struct quat_soa {
+		// [0] real component
+		// [1] i quaternion unit
+		// [2] j quaternion unit
+		// [3] k quaternion unit
+		float* data[4];
+		size_t count;
+	};
+
+	struct dualquat_soa {
+		// [0..3] rotation component, same order as quat_soa
+		// [4..7] dual component
+		float* data[8];
+		size_t count;
+
+		quat_soa real() const {
+			return quat_soa{ { data[0], data[1], data[2], data[3] }, count };
+		}
+
+		quat_soa dual() const {
+			return quat_soa{ { data[4], data[5], data[6], data[7] }, count };
+		}
+	};
+
+	// Four quaternions held one component per register. These are defined inline because
+	// batch kernels call them once per group of four entries.
+	class quat4 {
+	public:
+		__m128 data[4];
+
+		// loads entries i to i + n - 1 (n <= 4), missing lanes are zero
+		static quat4 load(const quat_soa& q, const size_t& i, const size_t& n = 4) {
+			quat4 result;
+			for (int c = 0; c < 4; c++) {
+				if (n == 4) {
+					result.data[c] = _mm_loadu_ps(q.data[c] + i);
+				}
+				else {
+					float lanes[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+					for (size_t k = 0; k < n; k++) {
+						lanes[k] = q.data[c][i + k];
+					}
+					result.data[c] = _mm_loadu_ps(lanes);
+				}
+			}
+
+			return result;
+		}
+
+		// stores lanes 0 to n - 1 to entries i to i + n - 1
+		void store(const quat_soa& q, const size_t& i, const size_t& n = 4) const {
+			for (int c = 0; c < 4; c++) {
+				if (n == 4) {
+					_mm_storeu_ps(q.data[c] + i, data[c]);
+				}
+				else {
+					float lanes[4];
+					_mm_storeu_ps(lanes, data[c]);
+					for (size_t k = 0; k < n; k++) {
+						q.data[c][i + k] = lanes[k];
+					}
+				}
+			}
+		}
+
+		quat4 conjugate() const {
+			const __m128 sign = _mm_set1_ps(-0.0f);
+			return quat4{ { data[0], _mm_xor_ps(data[1], sign), _mm_xor_ps(data[2], sign), _mm_xor_ps(data[3], sign) } };
+		}
+
+		__m128 dot(const quat4& other) const {
+			return _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(data[0], other.data[0]), _mm_mul_ps(data[1], other.data[1])),
+				_mm_add_ps(_mm_mul_ps(data[2], other.data[2]), _mm_mul_ps(data[3], other.data[3]))
+			);
+		}
+
+		__m128 norm2() const {
+			return this->dot(*this);
+		}
+
+		quat4 normalize() const;
+	};
+
+	inline quat4 operator*(const quat4& q1, const quat4& q2) {
+		const __m128* a = q1.data;
+		const __m128* b = q2.data;
+
+		return quat4{ {
+			_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_add_ps(_mm_mul_ps(a[2], b[2]), _mm_mul_ps(a[3], b[3]))),
+			_mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[1]), _mm_mul_ps(a[1], b[0])), _mm_sub_ps(_mm_mul_ps(a[2], b[3]), _mm_mul_ps(a[3], b[2]))),
+			_mm_add_ps(_mm_sub_ps(_mm_mul_ps(a[0], b[2]), _mm_mul_ps(a[1], b[3])), _mm_add_ps(_mm_mul_ps(a[2], b[0]), _mm_mul_ps(a[3], b[1]))),
+			_mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[3]), _mm_mul_ps(a[1], b[2])), _mm_sub_ps(_mm_mul_ps(a[3], b[0]), _mm_mul_ps(a[2], b[1])))
+		} };
+	}
+
+	inline quat4 operator*(const __m128& s, const quat4& q) {
+		return quat4{ { _mm_mul_ps(s, q.data[0]), _mm_mul_ps(s, q.data[1]), _mm_mul_ps(s, q.data[2]), _mm_mul_ps(s, q.data[3]) } };
+	}
+
+	inline quat4 operator+(const quat4& q1, const quat4& q2) {
+		return quat4{ {
+			_mm_add_ps(q1.data[0], q2.data[0]), _mm_add_ps(q1.data[1], q2.data[1]),
+			_mm_add_ps(q1.data[2], q2.data[2]), _mm_add_ps(q1.data[3], q2.data[3])
+		} };
+	}
+
+	inline quat4 operator-(const quat4& q1, const quat4& q2) {
+		return quat4{ {
+			_mm_sub_ps(q1.data[0], q2.data[0]), _mm_sub_ps(q1.data[1], q2.data[1]),
+			_mm_sub_ps(q1.data[2], q2.data[2]), _mm_sub_ps(q1.data[3], q2.data[3])
+		} };
+	}
+
+	inline quat4 quat4::normalize() const {
+		return _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(this->norm2())) * (*this);
+	}
+
+	class dualquat4 {
+	public:
+		// [0] rotation component
+		// [1] dual component
+		quat4 data[2];
+
+		static dualquat4 load(const dualquat_soa& d, const size_t& i, const size_t& n = 4) {
+			return dualquat4{ { quat4::load(d.real(), i, n), quat4::load(d.dual(), i, n) } };
+		}
+
+		void store(const dualquat_soa& d, const size_t& i, const size_t& n = 4) const {
+			data[0].store(d.real(), i, n);
+			data[1].store(d.dual(), i, n);
+		}
+
+		// inverse of a unit dual quaternion
+		dualquat4 conjugate() const {
+			return dualquat4{ { data[0].conjugate(), data[1].conjugate() } };
+		}
+
+		// inverse of any dual quaternion with a non zero real part
+		dualquat4 inverse() const {
+			const quat4 pInv = _mm_div_ps(_mm_set1_ps(1.0f), data[0].norm2()) * data[0].conjugate();
+			return dualquat4{ { pInv, _mm_set1_ps(-1.0f) * (pInv * (data[1] * pInv)) } };
+		}
+
+		// same as dualquat::normalize
+		dualquat4 normalize() const {
+			const __m128 nInv = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(data[0].norm2()));
+			const quat4 r = nInv * data[0];
+			const quat4 d = nInv * data[1];
+			return dualquat4{ { r, d - r.dot(d) * r } };
+		}
+	};
+
+	inline dualquat4 operator*(const dualquat4& d1, const dualquat4& d2) {
+		return dualquat4{ { d1.data[0] * d2.data[0], d1.data[0] * d2.data[1] + d1.data[1] * d2.data[0] } };
+	}
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//														arrays
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Owning structure of arrays storage. All components share one allocation, each one 64 byte
+	// aligned and readable and writable up to capacity(), which is a multiple of 16 entries, so
+	// kernels may load and store whole registers past size(). New entries are zero.
+	template <uint32_t Components>
+	class soa_array {
+	public:
+		size_t size() const {
+			return count;
+		}
+
+		size_t capacity() const {
+			return reserved;
+		}
+
+		// component c of every entry
+		float* data(const uint32_t& c) const {
+			return block + c * reserved;
+		}
+
+		void reserve(const size_t& n) {
+			if (n <= reserved) {
+				return;
+			}
+
+			const size_t grown = (n + 15) & ~size_t(15);
+			float* next = static_cast<float*>(_mm_malloc(Components * grown * sizeof(float), 64));
+			for (uint32_t c = 0; c < Components; c++) {
+				float* to = next + c * grown;
+				for (size_t i = 0; i < grown; i++) {
+					to[i] = i < count ? block[c * reserved + i] : 0.0f;
+				}
+			}
+
+			_mm_free(block);
+			block = next;
+			reserved = grown;
+		}
+
+		void resize(const size_t& n) {
+			reserve(n);
+			// stores past size() may have left anything in the padding
+			for (uint32_t c = 0; c < Components; c++) {
+				for (size_t i = count; i < n; i++) {
+					block[c * reserved + i] = 0.0f;
+				}
+			}
+			count = n;
+		}
+
+		void clear() {
+			resize(0);
+		}
+
+	protected:
+		soa_array(const size_t& n) {
+			resize(n);
+		}
+
+		soa_array(const soa_array& other) {
+			*this = other;
+		}
+
+		soa_array(soa_array&& other):
+			block(other.block), count(other.count), reserved(other.reserved) {
+			other.block = nullptr;
+			other.count = 0;
+			other.reserved = 0;
+		}
+
+		~soa_array() {
+			_mm_free(block);
+		}
+
+		soa_array& operator=(const soa_array& other) {
+			if (this != &other) {
+				resize(0);
+				reserve(other.count);
+				for (uint32_t c = 0; c < Components; c++) {
+					for (size_t i = 0; i < other.count; i++) {
+						block[c * reserved + i] = other.block[c * other.reserved + i];
+					}
+				}
+				count = other.count;
+			}
+			return *this;
+		}
+
+		soa_array& operator=(soa_array&& other) {
+			if (this != &other) {
+				_mm_free(block);
+				block = other.block;
+				count = other.count;
+				reserved = other.reserved;
+				other.block = nullptr;
+				other.count = 0;
+				other.reserved = 0;
+			}
+			return *this;
+		}
+
+		float* block = nullptr;
+		size_t count = 0;
+		size_t reserved = 0;
+	};
+
+	// Containers for bulk data that would otherwise be a std::vector of separately allocated
+	// objects. operator[] returns a proxy that converts to and from the value classes, load and
+	// store move four entries at a time in registers, and gather / scatter transpose interleaved
+	// buffers four entries per step. gather resizes the array to the span, scatter writes size()
+	// entries.
+	class vec4_array : public soa_array<4> {
+	public:
+		class reference {
+		public:
+			reference& operator=(const vec4& v);
+			reference& operator=(const reference& other);
+			operator vec4() const;
+			float& operator[](const uint32_t& c) const;
+
+		private:
+			friend class vec4_array;
+			reference(vec4_array* owner, const size_t& i);
+
+			vec4_array* owner;
+			size_t i;
+		};
+
+		explicit vec4_array(const size_t& count = 0);
+
+		reference operator[](const size_t& i);
+		vec4 operator[](const size_t& i) const;
+		void push_back(const vec4& v);
+
+		// components x, y, z, w of entries i to i + 3, i a multiple of 4
+		void load(const size_t& i, __m128* lanes) const;
+		void store(const size_t& i, const __m128* lanes);
+
+		void gather(const vec4_span& in);
+		void scatter(const vec4_span& out) const;
+	};
+
+	class quat_array : public soa_array<4> {
+	public:
+		class reference {
+		public:
+			reference& operator=(const quat& q);
+			reference& operator=(const reference& other);
+			operator quat() const;
+			float& operator[](const uint32_t& c) const;
+
+		private:
+			friend class quat_array;
+			reference(quat_array* owner, const size_t& i);
+
+			quat_array* owner;
+			size_t i;
+		};
+
+		explicit quat_array(const size_t& count = 0);
+
+		reference operator[](const size_t& i);
+		quat operator[](const size_t& i) const;
+		void push_back(const quat& q);
+		quat_soa soa() const;
+
+		// entries i to i + 3, i a multiple of 4
+		quat4 load(const size_t& i) const;
+		void store(const size_t& i, const quat4& q);
+
+		void gather(const quat_span& in);
+		void scatter(const quat_span& out) const;
+	};
+
+	class dualquat_array : public soa_array<8> {
+	public:
+		class reference {
+		public:
+			reference& operator=(const dualquat& d);
+			reference& operator=(const reference& other);
+			operator dualquat() const;
+			// rotation component then dual component, like dualquat_soa
+			float& operator[](const uint32_t& c) const;
+
+		private:
+			friend class dualquat_array;
+			reference(dualquat_array* owner, const size_t& i);
+
+			dualquat_array* owner;
+			size_t i;
+		};
+
+		explicit dualquat_array(const size_t& count = 0);
+
+		reference operator[](const size_t& i);
+		dualquat operator[](const size_t& i) const;
+		void push_back(const dualquat& d);
+		dualquat_soa soa() const;
+
+		// entries i to i + 3, i a multiple of 4
+		dualquat4 load(const size_t& i) const;
+		void store(const size_t& i, const dualquat4& d);
+
+		void gather(const dualquat_span& in);
+		void scatter(const dualquat_span& out) const;
+	};
+
+	class mat_array : public soa_array<16> {
+	public:
+		class reference {
+		public:
+			reference& operator=(const mat& m);
+			reference& operator=(const reference& other);
+			operator mat() const;
+			// row r of column c is component 4 c + r
+			float& operator[](const uint32_t& c) const;
+
+		private:
+			friend class mat_array;
+			reference(mat_array* owner, const size_t& i);
+
+			mat_array* owner;
+			size_t i;
+		};
+
+		explicit mat_array(const size_t& count = 0);
+
+		reference operator[](const size_t& i);
+		mat operator[](const size_t& i) const;
+		void push_back(const mat& m);
+
+		// components 0 to 15 of entries i to i + 3, i a multiple of 4
+		void load(const size_t& i, __m128* lanes) const;
+		void store(const size_t& i, const __m128* lanes);
+
+		// 16 floats per matrix, column major like mat
+		void gather(const float* matrices, const size_t& count);
+		void scatter(float* matrices) const;
+	};
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//														palette
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Batch composition of pose arrays, e.g. skinning palettes world[i] * inverseBind[i] and
+	// relative poses a[i]^-1 * b[i]. Outputs may alias inputs. Matrix outputs are 12 floats
+	// per entry, a row major 3x4 [R | t].
+	class palette {
+	public:
+		// out[i] = a[i] * b[i]
+		static void compose(const dualquat_soa& a, const dualquat_soa& b, const dualquat_soa& out);
+		static void compose(const dualquat_soa& a, const dualquat_soa& b, float* matrices, const bool& unit = true);
+		// out[i] = a[i]^-1 * b[i], unit inputs invert by conjugation
+		static void relative(const dualquat_soa& a, const dualquat_soa& b, const dualquat_soa& out, const bool& unit = true);
+		static void relative(const dualquat_soa& a, const dualquat_soa& b, float* matrices, const bool& unit = true);
+		// matrices of d[i], non unit entries are normalized when unit is false
+		static void toMatrices(const dualquat_soa& d, float* matrices, const bool& unit = true);
+	};
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//														scan
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct scanOptions {
+		// worker threads, 0 uses every hardware thread
+		uint32_t threads = 0;
+		// fewest entries worth giving a thread of its own
+		size_t minEntriesPerThread = 16384;
+		// renormalize the running product every this many entries, 0 never
+		size_t renormalizeEvery = 0;
+	};
+
+	// Prefix products of pose deltas, poses[i] = deltas[i] * poses[i - 1]. Composition is
+	// associative, so the array is cut into blocks that are scanned in parallel, four
+	// sub-blocks per thread in the lanes of one register, then fixed up by the products of
+	// the blocks before them. poses may alias deltas.
+	class scan {
+	public:
+		// poses[i] = deltas[i] * ... * deltas[0]
+		static void inclusive(const dualquat_soa& deltas, const dualquat_soa& poses, const scanOptions& options = scanOptions());
+		static void inclusive(const quat_soa& deltas, const quat_soa& poses, const scanOptions& options = scanOptions());
+		// poses[0] is the identity, poses[i] = deltas[i - 1] * ... * deltas[0]
+		static void exclusive(const dualquat_soa& deltas, const dualquat_soa& poses, const scanOptions& options = scanOptions());
+		static void exclusive(const quat_soa& deltas, const quat_soa& poses, const scanOptions& options = scanOptions());
+	};
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//														pose buffer
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Multi buffered pose store for one writer thread and any number of reader threads.
+	// The writer fills a free slot and publishes it with a single atomic store. Readers pin
+	// the published slot with a per slot reader count and read it in place, so neither side
+	// locks or copies and a reader never sees a slot that is being written. With slots >= 2 +
+	// the number of snapshots held at once the writer never waits.
+	class poseBuffer {
+	public:
+		// pins one published slot until destroyed, poses are 8 floats each (rotation, then dual component)
+		class snapshot {
+		public:
+			snapshot(snapshot&& other);
+			~snapshot();
+
+			snapshot& operator=(snapshot&& other);
+			dualquat_view operator[](const size_t& i) const;
+
+			dualquat_span poses() const;
+			// number of publishes before this one, 0 for the first
+			uint64_t generation() const;
+
+		private:
+			friend class poseBuffer;
+			snapshot(const poseBuffer* owner, const uint32_t& slot);
+			snapshot(const snapshot& other) = delete;
+			snapshot& operator=(const snapshot& other) = delete;
+
+			const poseBuffer* owner;
+			uint32_t slot;
+		};
+
+		poseBuffer(const size_t& poseCount, const uint32_t& slots = 3);
+		~poseBuffer();
+
+		// writer side: returns a slot to fill, waiting for readers to release one if needed
+		dualquat_span beginWrite();
+		// writer side: makes the slot returned by the last beginWrite the one readers see
+		void publish();
+
+		// reader side: pins the latest published slot, poses are identities before the first publish
+		snapshot read() const;
+
+		size_t size() const;
+
+	private:
+		poseBuffer(const poseBuffer& other) = delete;
+		poseBuffer& operator=(const poseBuffer& other) = delete;
+
+		float* slotData(const uint32_t& slot) const;
+
+		size_t poseCount;
+		uint32_t slots;
+		float* data;
+		uint64_t* generations;
+		std::atomic<uint32_t>* readers;
+		std::atomic<uint32_t> published;
+		uint32_t writing;
+		uint64_t nextGeneration;
+	};
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//														qtangent
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Tangent frames packed as one quaternion each, in quat order (real, i, j, k). The quaternion
+	// rotates x, y, z onto tangent, bitangent, normal; a negative real component marks a mirrored
+	// frame whose bitangent is flipped. The real component is kept at least bias away from zero
+	// so its sign survives snorm16 packing. Spans may point into interleaved vertex buffers.
+	class qtangent {
+	public:
+		static const float defaultBias;
+
+		// tangent, bitangent and normal of each vertex, w is ignored
+		static void encode(const vec4_span& tangents, const vec4_span& bitangents, const vec4_span& normals, const quat_span& out, const float& bias = defaultBias);
+		// columns 1 to 3 of each matrix are tangent, bitangent and normal
+		static void encode(const mat* frames, const quat_span& out, const size_t& count, const float& bias = defaultBias);
+		static void decode(const quat_span& qtangents, const vec4_span& tangents, const vec4_span& bitangents, const vec4_span& normals);
+
+		// 4 snorm16 per vertex, same component order
+		static void pack(const quat_span& qtangents, int16_t* out);
+		static void unpack(const int16_t* packed, const quat_span& out);
+
+		// rotates each frame by the blend of its joints' rotations in palette, influences joints and
+		// weights per vertex (weights may be null for 1 influence). out may alias qtangents
+		static void skin(
+			const quat_span& qtangents,
+			const uint32_t* joints,
+			const float* weights,
+			const uint32_t& influences,
+			const dualquat_soa& palette,
+			const quat_span& out,
+			const float& bias = defaultBias
+		);
+	};
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//														keyframes
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	enum class keyInterpolation {
+		// normalized linear blend of the two keys, cheapest to sample
+		dlb,
+		// constant speed screw motion between the two keys
+		sclerp
+	};
+
+	struct keyReduceOptions {
+		// largest translation error allowed at any sample, in pose units
+		float positionTolerance = 1e-3f;
+		// largest rotation error allowed at any sample, in radians
+		float angleTolerance = 1e-3f;
+		// how the keys are sampled back, the error is measured the same way
+		keyInterpolation interpolation = keyInterpolation::dlb;
+		// least squares refit of neighbouring keys so more keys can be dropped, keys then
+		// no longer equal samples. Offline only
+		bool refit = false;
+		// worker threads for batches of tracks, 0 uses every hardware thread
+		uint32_t threads = 0;
+	};
+
+	// One sampled trajectory and room for its keys. The key arrays are caller owned and
+	// sized for samples.count entries, the worst case.
+	struct keyTrack {
+		// sample times, strictly increasing
+		const float* times = nullptr;
+		dualquat_soa samples;
+
+		float* keyTimes = nullptr;
+		dualquat_soa keys;
+		// sample index of each key, may be null
+		uint32_t* keyIndices = nullptr;
+		// set by reduce
+		size_t keyCount = 0;
+	};
+
+	// Drops samples that the remaining keys reconstruct within tolerance. Each span runs from
+	// the last key to the furthest sample it still covers; samples are unit dual quaternions
+	// and the first and last are always kept unchanged, refit included.
+	class keyframes {
+	public:
+		static void reduce(keyTrack& track, const keyReduceOptions& options = keyReduceOptions());
+		// reduces count independent tracks in parallel
+		static void reduce(keyTrack* tracks, const size_t& count, const keyReduceOptions& options = keyReduceOptions());
+
+		// evaluates the keys at times, which are clamped to the key range
+		static void sample(
+			const float* keyTimes,
+			const dualquat_soa& keys,
+			const float* times,
+			const dualquat_soa& out,
+			const keyInterpolation& interpolation = keyInterpolation::dlb
+		);
+	};
+
+	// Streaming reducer for one track with bounded memory. Each key is decided greedily: the
+	// current span is extended while every sample since the last key stays in tolerance, and
+	// at most window samples are held. Keys are always samples, refit and threads are ignored.
+	class keyStream {
+	public:
+		keyStream(const keyReduceOptions& options = keyReduceOptions(), const size_t& window = 256);
+		~keyStream();
+
+		// adds the next sample, returns true and writes key when a key has been decided
+		bool push(const float& time, const dualquat_view& pose, float& keyTime, const dualquat_view& key);
+		// ends the track, returns true and writes the last key if one is pending
+		bool flush(float& keyTime, const dualquat_view& key);
+		// starts a new track with the same options
+		void reset();
+
+	private:
+		keyStream(const keyStream& other) = delete;
+		keyStream& operator=(const keyStream& other) = delete;
+
+		keyReduceOptions options;
+		size_t window;
+		size_t buffered;
+		bool anchored;
+		float anchorTime;
+		float anchor[8];
+		float* times;
+		float* poses;
+	};
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//														ik
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	enum class ikMethod {
+		// cyclic coordinate descent, rotates one joint at a time from the end of the chain
+		ccd,
+		// forward and backward reaching on joint positions, then turned back into rotations
+		fabrik
+	};
+
+	// Called after every joint update with the local rotation of joint of the four chains
+	// starting at chain, may change it to keep the joint in range. Lanes past the end of the
+	// batch hold garbage.
+	typedef std::function<void(const uint32_t& joint, const size_t& chain, quat4& rotation)> ikJointLimit;
+
+	struct ikOptions {
+		ikMethod method = ikMethod::fabrik;
+		// most solver iterations per chain
+		uint32_t iterations = 16;
+		// a chain stops once its end effector is this close to its target
+		float tolerance = 1e-3f;
+		// optional joint limits
+		ikJointLimit limit;
+		// worker threads, 0 uses every hardware thread
+		uint32_t threads = 0;
+		// fewest chains worth giving a thread of its own
+		size_t minChainsPerThread = 256;
+	};
+
+	// A batch of chains with the same number of joints, stored joint major so that joint j of
+	// four consecutive chains loads into one register: entry j * count + i belongs to joint j
+	// of chain i.
+	struct ikChains {
+		// number of chains
+		size_t count;
+		// joints per chain
+		uint32_t joints;
+		// local rotation of each joint relative to its parent, solved in place
+		quat_soa rotations;
+		// x, y, z of the bone from each joint to the next joint, or to the end effector for the
+		// last joint, in the joint's own frame
+		float* offsets[3];
+		// parent pose of the first joint of each chain, unit dual quaternions
+		dualquat_soa roots;
+		// x, y, z of each chain's target in the same space as roots, where the end effector is
+		// measured from the root translation on
+		float* targets[3];
+	};
+
+	class ik {
+	public:
+		// solves every chain four at a time, returns the number that reached tolerance
+		static size_t solve(const ikChains& chains, const ikOptions& options = ikOptions());
+
+		// joint limits for use in an ikJointLimit
+		// limits the rotation to at most maxRadians from the rest pose
+		static void clampAngle(quat4& rotation, const float& maxRadians);
+		// keeps only the rotation about axis and limits its angle to [minRadians, maxRadians]
+		static void hinge(quat4& rotation, const vec4& axis, const float& minRadians, const float& maxRadians);
+	};
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//														bounds
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct sphere_soa {
+		// [0..2] center x, y, z
+		// [3] radius
+		float* data[4];
+		size_t count;
+	};
+
+	struct aabb_soa {
+		// [0..2] center x, y, z
+		// [3..5] half extent along x, y, z
+		float* data[6];
+		size_t count;
+	};
+
+	// Moves the bounds of each instance i by its pose i, four instances per step. Poses are rigid,
+	// so sphere radii are kept as they are, and boxes are refit around the rotated box with Arvo's
+	// method (the new half extents are the absolute rotation matrix times the old ones). Matrices
+	// are row major 3 x 4 as written by palette. out may alias in.
+	class bounds {
+	public:
+		static void transform(const sphere_soa& in, const dualquat_soa& poses, const sphere_soa& out);
+		static void transform(const sphere_soa& in, const float* matrices, const sphere_soa& out);
+		static void transform(const aabb_soa& in, const dualquat_soa& poses, const aabb_soa& out);
+		static void transform(const aabb_soa& in, const float* matrices, const aabb_soa& out);
+	};
+
+	class frustum {
+	public:
+		// left, right, bottom, top, near, far as (a, b, c, d) with a x + b y + c z + d >= 0
+		// inside and (a, b, c) unit length
+		float planes[6][4];
+
+		// planes of a view projection matrix with clip space depth in [-w, w]
+		static frustum fromMatrix(const mat& viewProjection);
+
+		// sets bit i % 8 of visible[i / 8] when bounds i is not completely outside any plane,
+		// eight bounds per step. visible needs (count + 7) / 8 bytes, unused bits are cleared
+		void cull(const sphere_soa& spheres, uint8_t* visible) const;
+		void cull(const aabb_soa& boxes, uint8_t* visible) const;
+		// same as bounds::transform followed by cull without writing the moved bounds
+		void cull(const sphere_soa& spheres, const dualquat_soa& poses, uint8_t* visible) const;
+		void cull(const sphere_soa& spheres, const float* matrices, uint8_t* visible) const;
+		void cull(const aabb_soa& boxes, const dualquat_soa& poses, uint8_t* visible) const;
+		void cull(const aabb_soa& boxes, const float* matrices, uint8_t* visible) const;
+	};
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//														sweep
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Sub frame samples of the screw motion between two unit dual quaternion poses, the path
+	// sclerp keys follow, for motion blur and continuous collision. The screw of from^-1 * to is
+	// found once. Samples then step its angle with a rotation recurrence, four samples per
+	// register, instead of calling sin and cos for every sample. Sample i of count is at
+	// t = i / (count - 1), count 1 samples from only.
+	class sweep {
+	public:
+		sweep(const dualquat& from, const dualquat& to);
+
+		// rotation about the screw axis in radians, in [0, pi], and translation along it
+		float angle() const;
+		float slide() const;
+
+		dualquat at(const float& t) const;
+
+		// out.count poses
+		void sample(const dualquat_soa& out) const;
+		// points moved to every sample, out[s * points.size() + p] holds point p at sample s.
+		// w = 1 entries are points, w = 0 entries directions
+		void transform(const vec4_span& points, const size_t& samples, const vec4_span& out) const;
+		// box around the box center +- halfExtents over the whole motion. The box is bounded
+		// exactly at samples poses, samples >= 2, and every arc between two of them by its
+		// sagitta, so more samples only make the bounds tighter
+		void bounds(const float* center, const float* halfExtents, const size_t& samples, float* sweptCenter, float* sweptHalfExtents) const;
+
+	private:
+		// steps poses four at a time
+		struct sampler;
+
+		// from and the screw of from^-1 * to, on from's hemisphere
+		float from[8];
+		float theta;
+		float pitch;
+		float axis[3];
+		float moment[3];
+		// the screw is ill defined for tiny rotations, which blend the delta instead
+		bool blend;
+		float delta[8];
+	};
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//														pose index
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// distance = rotationWeight * rotation angle in radians + translationWeight * translation distance
+	struct poseMetric {
+		float rotationWeight = 1.0f;
+		float translationWeight = 1.0f;
+	};
+
+	struct poseMatch {
+		// position of the pose in the array the index was built from
+		uint32_t index;
+		float distance;
+	};
+
+	// Nearest neighbour search over a fixed set of unit dual quaternion poses. The rotation angle
+	// and the translation distance are both metrics, so their weighted sum is one too and a
+	// vantage point tree can prune subtrees exactly with the triangle inequality. Leaves and the
+	// brute force scan test four poses per step from a structure of arrays copy of the poses.
+	class poseIndex {
+	public:
+		poseIndex(const dualquat_soa& poses, const poseMetric& metric = poseMetric(), const uint32_t& leafSize = 64);
+		~poseIndex();
+
+		size_t size() const;
+		float distance(const dualquat_view& a, const dualquat_view& b) const;
+
+		// Each writes the k nearest poses to out sorted by distance and returns how many it found.
+		// Entries past that have index 0xffffffff and an infinite distance.
+		// tests every pose
+		uint32_t bruteForce(const dualquat_view& query, const uint32_t& k, poseMatch* out) const;
+		// through the tree, epsilon > 0 also skips subtrees that can only beat the current kth
+		// match by a factor below 1 + epsilon, trading recall for speed
+		uint32_t nearest(const dualquat_view& query, const uint32_t& k, poseMatch* out, const float& epsilon = 0.0f) const;
+		// k matches per query at out + k * i, queries are split across threads, 0 uses every hardware thread
+		void nearest(const dualquat_span& queries, const uint32_t& k, poseMatch* out, const float& epsilon = 0.0f, const uint32_t& threads = 0) const;
+
+	private:
+		poseIndex(const poseIndex& other) = delete;
+		poseIndex& operator=(const poseIndex& other) = delete;
+
+		struct node {
+			// rotation and translation of the vantage point
+			float vantage[7];
+			// poses [begin, middle) are at most inner from the vantage point, [middle, end) at least outer
+			float inner;
+			float outer;
+			uint32_t begin;
+			uint32_t middle;
+			uint32_t end;
+			// -1 for leaves
+			int32_t children[2];
+		};
+
+		// sorted k nearest so far
+		struct matches;
+
+		// order holds original indices, distance is scratch space for the split
+		int32_t build(const uint32_t& begin, const uint32_t& end, const float* points, poseMatch* order, uint32_t& seed);
+		// query is the rotation and translation broadcast to all lanes
+		void search(const int32_t& n, const __m128* query, matches& best, const float& scale) const;
+		void scan(const uint32_t& begin, const uint32_t& end, const __m128* query, matches& best) const;
+		__m128 distance(const __m128* a, const __m128* b) const;
+
+		poseMetric metric;
+		uint32_t leafSize;
+		size_t count;
+		size_t stride;
+		// 7 arrays of stride floats: rotation (real, i, j, k) then translation (x, y, z), in tree order
+		float* data;
+		// original index of each pose in tree order
+		uint32_t* indices;
+		std::vector<node> nodes;
+	};
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//														trace
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct traceEvent {
+		// the string literal the zone was opened with
+		const char* name;
+		// nanoseconds on trace::now()
+		uint64_t begin;
+		uint64_t end;
+		// threads are numbered from 0 in the order they first recorded a zone, numbers of
+		// finished threads are given to new ones
+		uint32_t thread;
+		// zones already open on the thread when this one began
+		uint32_t depth;
+	};
+
+	// Zone recording for finding where frame time goes. Each thread appends to a ring of its own,
+	// so recording takes no lock and never waits on other threads. Only the first zone on a
+	// thread locks, to register its ring. Full rings keep the newest ringSize events. Nothing is
+	// recorded until enable(true).
+	class trace {
+	public:
+		static const size_t ringSize = 1 << 16;
+
+		static void enable(const bool& on);
+		static bool enabled();
+		// nanoseconds since the first call
+		static uint64_t now();
+		static void record(const char* name, const uint64_t& begin, const uint64_t& end, const uint32_t& depth);
+
+		// every thread's events sorted by begin, events that are being recorded during the call may be missing
+		static std::vector<traceEvent> collect();
+		// forgets every event recorded so far
+		static void clear();
+
+		// Chrome trace event format, opens in chrome://tracing and Perfetto
+		static std::string toChromeJson(const std::vector<traceEvent>& events);
+		// writes toChromeJson(collect()), false if the file could not be written
+		static bool exportChrome(const std::string& path);
+	};
+
+	// records its lifetime as one zone, through GMATH_TRACE_ZONE or directly
+	class traceZone {
+	public:
+		traceZone(const char* name);
+		~traceZone();
+
+	private:
+		traceZone(const traceZone& other) = delete;
+		traceZone& operator=(const traceZone& other) = delete;
+
+		// null when tracing was disabled at the start of the zone
+		const char* name;
+		uint64_t begin;
+		uint32_t depth;
+	};
 }
 
 #endif // !G_MATH_HPP
@@ -0,0 +1,379 @@
+#include "..\include\gmath.hpp"
+
+using namespace gmath;
+
+// Component arrays are 64 byte aligned and padded to a multiple of 16 entries, so these always
+// move whole registers and only the interleaved side checks for a partial group at the end.
+
+// count entries of floats floats each, spaced stride bytes apart, into the component arrays to.
+// Whole groups of four keep their rows in named registers, indexing a local array with a lane
+// test per row made the compilers spill it and ran no faster than copying one float at a time.
+static void transposeIn(const unsigned char* base, const size_t& stride, const size_t& count, const uint32_t& floats, float* const* to) {
+	const size_t whole = count & ~static_cast<size_t>(3);
+	for (size_t i = 0; i < whole; i += 4) {
+		const unsigned char* row = base + i * stride;
+		for (uint32_t k = 0; k < floats; k += 4) {
+			__m128 r0 = _mm_loadu_ps(reinterpret_cast<const float*>(row) + k);
+			__m128 r1 = _mm_loadu_ps(reinterpret_cast<const float*>(row + stride) + k);
+			__m128 r2 = _mm_loadu_ps(reinterpret_cast<const float*>(row + 2 * stride) + k);
+			__m128 r3 = _mm_loadu_ps(reinterpret_cast<const float*>(row + 3 * stride) + k);
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_store_ps(to[k] + i, r0);
+			_mm_store_ps(to[k + 1] + i, r1);
+			_mm_store_ps(to[k + 2] + i, r2);
+			_mm_store_ps(to[k + 3] + i, r3);
+		}
+	}
+
+	// the partial group zero fills the padding lanes
+	if (whole < count) {
+		for (uint32_t k = 0; k < floats; k++) {
+			_mm_store_ps(to[k] + whole, _mm_setzero_ps());
+			for (size_t i = whole; i < count; i++) {
+				to[k][i] = reinterpret_cast<const float*>(base + i * stride)[k];
+			}
+		}
+	}
+}
+
+static void transposeOut(float* const* from, const size_t& count, const uint32_t& floats, unsigned char* base, const size_t& stride) {
+	const size_t whole = count & ~static_cast<size_t>(3);
+	for (size_t i = 0; i < whole; i += 4) {
+		unsigned char* row = base + i * stride;
+		for (uint32_t k = 0; k < floats; k += 4) {
+			__m128 r0 = _mm_load_ps(from[k] + i);
+			__m128 r1 = _mm_load_ps(from[k + 1] + i);
+			__m128 r2 = _mm_load_ps(from[k + 2] + i);
+			__m128 r3 = _mm_load_ps(from[k + 3] + i);
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_storeu_ps(reinterpret_cast<float*>(row) + k, r0);
+			_mm_storeu_ps(reinterpret_cast<float*>(row + stride) + k, r1);
+			_mm_storeu_ps(reinterpret_cast<float*>(row + 2 * stride) + k, r2);
+			_mm_storeu_ps(reinterpret_cast<float*>(row + 3 * stride) + k, r3);
+		}
+	}
+
+	for (size_t i = whole; i < count; i++) {
+		for (uint32_t k = 0; k < floats; k++) {
+			reinterpret_cast<float*>(base + i * stride)[k] = from[k][i];
+		}
+	}
+}
+
+template <typename Array>
+static void grow(Array& a) {
+	if (a.size() == a.capacity()) {
+		a.reserve(a.capacity() < 16 ? 16 : 2 * a.capacity());
+	}
+	a.resize(a.size() + 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														vec4_array
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+vec4_array::reference::reference(vec4_array* owner, const size_t& i):
+	owner(owner), i(i) {
+}
+
+vec4_array::reference& vec4_array::reference::operator=(const vec4& v) {
+	for (uint32_t c = 0; c < 4; c++) {
+		owner->data(c)[i] = v[c];
+	}
+	return *this;
+}
+
+vec4_array::reference& vec4_array::reference::operator=(const reference& other) {
+	for (uint32_t c = 0; c < 4; c++) {
+		owner->data(c)[i] = other[c];
+	}
+	return *this;
+}
+
+vec4_array::reference::operator vec4() const {
+	return vec4(owner->data(0)[i], owner->data(1)[i], owner->data(2)[i], owner->data(3)[i]);
+}
+
+float& vec4_array::reference::operator[](const uint32_t& c) const {
+	return owner->data(c)[i];
+}
+
+vec4_array::vec4_array(const size_t& count):
+	soa_array<4>(count) {
+}
+
+vec4_array::reference vec4_array::operator[](const size_t& i) {
+	return reference(this, i);
+}
+
+vec4 vec4_array::operator[](const size_t& i) const {
+	return vec4(data(0)[i], data(1)[i], data(2)[i], data(3)[i]);
+}
+
+void vec4_array::push_back(const vec4& v) {
+	grow(*this);
+	(*this)[count - 1] = v;
+}
+
+void vec4_array::load(const size_t& i, __m128* lanes) const {
+	for (uint32_t c = 0; c < 4; c++) {
+		lanes[c] = _mm_load_ps(data(c) + i);
+	}
+}
+
+void vec4_array::store(const size_t& i, const __m128* lanes) {
+	for (uint32_t c = 0; c < 4; c++) {
+		_mm_store_ps(data(c) + i, lanes[c]);
+	}
+}
+
+void vec4_array::gather(const vec4_span& in) {
+	GMATH_TRACE_ZONE("vec4_array::gather");
+	resize(in.size());
+	float* to[4] = { data(0), data(1), data(2), data(3) };
+	transposeIn(in.base, in.stride, in.size(), 4, to);
+}
+
+void vec4_array::scatter(const vec4_span& out) const {
+	GMATH_TRACE_ZONE("vec4_array::scatter");
+	float* from[4] = { data(0), data(1), data(2), data(3) };
+	transposeOut(from, count, 4, out.base, out.stride);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														quat_array
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+quat_array::reference::reference(quat_array* owner, const size_t& i):
+	owner(owner), i(i) {
+}
+
+quat_array::reference& quat_array::reference::operator=(const quat& q) {
+	for (uint32_t c = 0; c < 4; c++) {
+		owner->data(c)[i] = q[c];
+	}
+	return *this;
+}
+
+quat_array::reference& quat_array::reference::operator=(const reference& other) {
+	for (uint32_t c = 0; c < 4; c++) {
+		owner->data(c)[i] = other[c];
+	}
+	return *this;
+}
+
+quat_array::reference::operator quat() const {
+	return quat(owner->data(0)[i], owner->data(1)[i], owner->data(2)[i], owner->data(3)[i]);
+}
+
+float& quat_array::reference::operator[](const uint32_t& c) const {
+	return owner->data(c)[i];
+}
+
+quat_array::quat_array(const size_t& count):
+	soa_array<4>(count) {
+}
+
+quat_array::reference quat_array::operator[](const size_t& i) {
+	return reference(this, i);
+}
+
+quat quat_array::operator[](const size_t& i) const {
+	return quat(data(0)[i], data(1)[i], data(2)[i], data(3)[i]);
+}
+
+void quat_array::push_back(const quat& q) {
+	grow(*this);
+	(*this)[count - 1] = q;
+}
+
+quat_soa quat_array::soa() const {
+	return quat_soa{ { data(0), data(1), data(2), data(3) }, count };
+}
+
+quat4 quat_array::load(const size_t& i) const {
+	return quat4{ { _mm_load_ps(data(0) + i), _mm_load_ps(data(1) + i), _mm_load_ps(data(2) + i), _mm_load_ps(data(3) + i) } };
+}
+
+void quat_array::store(const size_t& i, const quat4& q) {
+	for (uint32_t c = 0; c < 4; c++) {
+		_mm_store_ps(data(c) + i, q.data[c]);
+	}
+}
+
+void quat_array::gather(const quat_span& in) {
+	GMATH_TRACE_ZONE("quat_array::gather");
+	resize(in.size());
+	float* to[4] = { data(0), data(1), data(2), data(3) };
+	transposeIn(in.base, in.stride, in.size(), 4, to);
+}
+
+void quat_array::scatter(const quat_span& out) const {
+	GMATH_TRACE_ZONE("quat_array::scatter");
+	float* from[4] = { data(0), data(1), data(2), data(3) };
+	transposeOut(from, count, 4, out.base, out.stride);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														dualquat_array
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+dualquat_array::reference::reference(dualquat_array* owner, const size_t& i):
+	owner(owner), i(i) {
+}
+
+dualquat_array::reference& dualquat_array::reference::operator=(const dualquat& d) {
+	for (uint32_t c = 0; c < 8; c++) {
+		owner->data(c)[i] = d[c / 4][c % 4];
+	}
+	return *this;
+}
+
+dualquat_array::reference& dualquat_array::reference::operator=(const reference& other) {
+	for (uint32_t c = 0; c < 8; c++) {
+		owner->data(c)[i] = other[c];
+	}
+	return *this;
+}
+
+dualquat_array::reference::operator dualquat() const {
+	return dualquat(
+		quat(owner->data(0)[i], owner->data(1)[i], owner->data(2)[i], owner->data(3)[i]),
+		quat(owner->data(4)[i], owner->data(5)[i], owner->data(6)[i], owner->data(7)[i])
+	);
+}
+
+float& dualquat_array::reference::operator[](const uint32_t& c) const {
+	return owner->data(c)[i];
+}
+
+dualquat_array::dualquat_array(const size_t& count):
+	soa_array<8>(count) {
+}
+
+dualquat_array::reference dualquat_array::operator[](const size_t& i) {
+	return reference(this, i);
+}
+
+dualquat dualquat_array::operator[](const size_t& i) const {
+	return dualquat(
+		quat(data(0)[i], data(1)[i], data(2)[i], data(3)[i]),
+		quat(data(4)[i], data(5)[i], data(6)[i], data(7)[i])
+	);
+}
+
+void dualquat_array::push_back(const dualquat& d) {
+	grow(*this);
+	(*this)[count - 1] = d;
+}
+
+dualquat_soa dualquat_array::soa() const {
+	return dualquat_soa{ { data(0), data(1), data(2), data(3), data(4), data(5), data(6), data(7) }, count };
+}
+
+dualquat4 dualquat_array::load(const size_t& i) const {
+	dualquat4 d;
+	for (uint32_t c = 0; c < 8; c++) {
+		d.data[c / 4].data[c % 4] = _mm_load_ps(data(c) + i);
+	}
+	return d;
+}
+
+void dualquat_array::store(const size_t& i, const dualquat4& d) {
+	for (uint32_t c = 0; c < 8; c++) {
+		_mm_store_ps(data(c) + i, d.data[c / 4].data[c % 4]);
+	}
+}
+
+void dualquat_array::gather(const dualquat_span& in) {
+	GMATH_TRACE_ZONE("dualquat_array::gather");
+	resize(in.size());
+	float* to[8] = { data(0), data(1), data(2), data(3), data(4), data(5), data(6), data(7) };
+	transposeIn(in.base, in.stride, in.size(), 8, to);
+}
+
+void dualquat_array::scatter(const dualquat_span& out) const {
+	GMATH_TRACE_ZONE("dualquat_array::scatter");
+	float* from[8] = { data(0), data(1), data(2), data(3), data(4), data(5), data(6), data(7) };
+	transposeOut(from, count, 8, out.base, out.stride);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														mat_array
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+mat_array::reference::reference(mat_array* owner, const size_t& i):
+	owner(owner), i(i) {
+}
+
+mat_array::reference& mat_array::reference::operator=(const mat& m) {
+	for (uint32_t c = 0; c < 16; c++) {
+		owner->data(c)[i] = m[c / 4][c % 4];
+	}
+	return *this;
+}
+
+mat_array::reference& mat_array::reference::operator=(const reference& other) {
+	for (uint32_t c = 0; c < 16; c++) {
+		owner->data(c)[i] = other[c];
+	}
+	return *this;
+}
+
+mat_array::reference::operator mat() const {
+	const mat_array& m = *owner;
+	return m[i];
+}
+
+float& mat_array::reference::operator[](const uint32_t& c) const {
+	return owner->data(c)[i];
+}
+
+mat_array::mat_array(const size_t& count):
+	soa_array<16>(count) {
+}
+
+mat_array::reference mat_array::operator[](const size_t& i) {
+	return reference(this, i);
+}
+
+mat mat_array::operator[](const size_t& i) const {
+	return mat(
+		vec4(data(0)[i], data(1)[i], data(2)[i], data(3)[i]),
+		vec4(data(4)[i], data(5)[i], data(6)[i], data(7)[i]),
+		vec4(data(8)[i], data(9)[i], data(10)[i], data(11)[i]),
+		vec4(data(12)[i], data(13)[i], data(14)[i], data(15)[i])
+	);
+}
+
+void mat_array::push_back(const mat& m) {
+	grow(*this);
+	(*this)[count - 1] = m;
+}
+
+void mat_array::load(const size_t& i, __m128* lanes) const {
+	for (uint32_t c = 0; c < 16; c++) {
+		lanes[c] = _mm_load_ps(data(c) + i);
+	}
+}
+
+void mat_array::store(const size_t& i, const __m128* lanes) {
+	for (uint32_t c = 0; c < 16; c++) {
+		_mm_store_ps(data(c) + i, lanes[c]);
+	}
+}
+
+void mat_array::gather(const float* matrices, const size_t& count) {
+	GMATH_TRACE_ZONE("mat_array::gather");
+	resize(count);
+	float* to[16];
+	for (uint32_t c = 0; c < 16; c++) {
+		to[c] = data(c);
+	}
+	transposeIn(reinterpret_cast<const unsigned char*>(matrices), 16 * sizeof(float), count, 16, to);
+}
+
+void mat_array::scatter(float* matrices) const {
+	GMATH_TRACE_ZONE("mat_array::scatter");
+	float* from[16];
+	for (uint32_t c = 0; c < 16; c++) {
+		from[c] = data(c);
+	}
+	transposeOut(from, count, 16, reinterpret_cast<unsigned char*>(matrices), 16 * sizeof(float));
+}
\ No newline at end of file
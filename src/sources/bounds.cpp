@@ -0,0 +1,343 @@
+#include "..\include\gmath.hpp"
+
+using namespace gmath;
+
+// rotation matrix m[row][col] and translation of four rigid poses, one per lane
+struct pose4 {
+	__m128 m[3][3];
+	__m128 t[3];
+};
+
+static pose4 toPose(const dualquat4& d) {
+	const __m128* r = d.data[0].data;
+	const __m128* q = d.data[1].data;
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 two = _mm_set1_ps(2.0f);
+
+	const __m128 xx = _mm_mul_ps(r[1], r[1]);
+	const __m128 yy = _mm_mul_ps(r[2], r[2]);
+	const __m128 zz = _mm_mul_ps(r[3], r[3]);
+	const __m128 xy = _mm_mul_ps(r[1], r[2]);
+	const __m128 xz = _mm_mul_ps(r[1], r[3]);
+	const __m128 yz = _mm_mul_ps(r[2], r[3]);
+	const __m128 wx = _mm_mul_ps(r[0], r[1]);
+	const __m128 wy = _mm_mul_ps(r[0], r[2]);
+	const __m128 wz = _mm_mul_ps(r[0], r[3]);
+
+	pose4 p;
+	p.m[0][0] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)));
+	p.m[0][1] = _mm_mul_ps(two, _mm_sub_ps(xy, wz));
+	p.m[0][2] = _mm_mul_ps(two, _mm_add_ps(xz, wy));
+	p.m[1][0] = _mm_mul_ps(two, _mm_add_ps(xy, wz));
+	p.m[1][1] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)));
+	p.m[1][2] = _mm_mul_ps(two, _mm_sub_ps(yz, wx));
+	p.m[2][0] = _mm_mul_ps(two, _mm_sub_ps(xz, wy));
+	p.m[2][1] = _mm_mul_ps(two, _mm_add_ps(yz, wx));
+	p.m[2][2] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)));
+
+	// t = 2 q r* = 2 (rw qv - qw rv + rv x qv)
+	p.t[0] = _mm_mul_ps(two, _mm_add_ps(
+		_mm_sub_ps(_mm_mul_ps(r[0], q[1]), _mm_mul_ps(q[0], r[1])),
+		_mm_sub_ps(_mm_mul_ps(r[2], q[3]), _mm_mul_ps(r[3], q[2]))
+	));
+	p.t[1] = _mm_mul_ps(two, _mm_add_ps(
+		_mm_sub_ps(_mm_mul_ps(r[0], q[2]), _mm_mul_ps(q[0], r[2])),
+		_mm_sub_ps(_mm_mul_ps(r[3], q[1]), _mm_mul_ps(r[1], q[3]))
+	));
+	p.t[2] = _mm_mul_ps(two, _mm_add_ps(
+		_mm_sub_ps(_mm_mul_ps(r[0], q[3]), _mm_mul_ps(q[0], r[3])),
+		_mm_sub_ps(_mm_mul_ps(r[1], q[2]), _mm_mul_ps(r[2], q[1]))
+	));
+
+	return p;
+}
+
+// loads n (<= 4) row major 3 x 4 matrices
+static pose4 toPose(const float* matrices, const size_t& n) {
+	pose4 p;
+	for (int row = 0; row < 3; row++) {
+		__m128 lanes[4];
+		for (size_t k = 0; k < 4; k++) {
+			lanes[k] = k < n ? _mm_loadu_ps(matrices + 12 * k + 4 * row) : _mm_setzero_ps();
+		}
+		_MM_TRANSPOSE4_PS(lanes[0], lanes[1], lanes[2], lanes[3]);
+		p.m[row][0] = lanes[0];
+		p.m[row][1] = lanes[1];
+		p.m[row][2] = lanes[2];
+		p.t[row] = lanes[3];
+	}
+
+	return p;
+}
+
+static __m128 load(const float* data, const size_t& i, const size_t& n) {
+	if (n == 4) {
+		return _mm_loadu_ps(data + i);
+	}
+
+	float lanes[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (size_t k = 0; k < n; k++) {
+		lanes[k] = data[i + k];
+	}
+	return _mm_loadu_ps(lanes);
+}
+
+static void store(float* data, const size_t& i, const size_t& n, const __m128& v) {
+	if (n == 4) {
+		_mm_storeu_ps(data + i, v);
+		return;
+	}
+
+	float lanes[4];
+	_mm_storeu_ps(lanes, v);
+	for (size_t k = 0; k < n; k++) {
+		data[i + k] = lanes[k];
+	}
+}
+
+// centers held in data[0..2] of instances i to i + n - 1 moved by p
+static void moveCenters(float* const* data, const size_t& i, const size_t& n, const pose4& p, __m128* center) {
+	const __m128 x = load(data[0], i, n);
+	const __m128 y = load(data[1], i, n);
+	const __m128 z = load(data[2], i, n);
+	for (int row = 0; row < 3; row++) {
+		center[row] = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(p.m[row][0], x), _mm_mul_ps(p.m[row][1], y)),
+			_mm_add_ps(_mm_mul_ps(p.m[row][2], z), p.t[row])
+		);
+	}
+}
+
+// half extents held in data[3..5] refit around the rotated boxes, Arvo's method
+static void moveExtents(float* const* data, const size_t& i, const size_t& n, const pose4& p, __m128* extent) {
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	const __m128 ex = load(data[3], i, n);
+	const __m128 ey = load(data[4], i, n);
+	const __m128 ez = load(data[5], i, n);
+	for (int row = 0; row < 3; row++) {
+		extent[row] = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(_mm_and_ps(p.m[row][0], absMask), ex), _mm_mul_ps(_mm_and_ps(p.m[row][1], absMask), ey)),
+			_mm_mul_ps(_mm_and_ps(p.m[row][2], absMask), ez)
+		);
+	}
+}
+
+static void transformSpheres(const sphere_soa& in, const sphere_soa& out, const size_t& i, const size_t& n, const pose4& p) {
+	__m128 center[3];
+	moveCenters(in.data, i, n, p, center);
+	for (int row = 0; row < 3; row++) {
+		store(out.data[row], i, n, center[row]);
+	}
+	if (out.data[3] != in.data[3]) {
+		store(out.data[3], i, n, load(in.data[3], i, n));
+	}
+}
+
+static void transformBoxes(const aabb_soa& in, const aabb_soa& out, const size_t& i, const size_t& n, const pose4& p) {
+	__m128 center[3];
+	__m128 extent[3];
+	moveCenters(in.data, i, n, p, center);
+	moveExtents(in.data, i, n, p, extent);
+	for (int row = 0; row < 3; row++) {
+		store(out.data[row], i, n, center[row]);
+		store(out.data[3 + row], i, n, extent[row]);
+	}
+}
+
+void bounds::transform(const sphere_soa& in, const dualquat_soa& poses, const sphere_soa& out) {
+	GMATH_TRACE_ZONE("bounds::transform");
+	for (size_t i = 0; i < in.count; i += 4) {
+		const size_t n = in.count - i < 4 ? in.count - i : 4;
+		transformSpheres(in, out, i, n, toPose(dualquat4::load(poses, i, n)));
+	}
+}
+
+void bounds::transform(const sphere_soa& in, const float* matrices, const sphere_soa& out) {
+	GMATH_TRACE_ZONE("bounds::transform");
+	for (size_t i = 0; i < in.count; i += 4) {
+		const size_t n = in.count - i < 4 ? in.count - i : 4;
+		transformSpheres(in, out, i, n, toPose(matrices + 12 * i, n));
+	}
+}
+
+void bounds::transform(const aabb_soa& in, const dualquat_soa& poses, const aabb_soa& out) {
+	GMATH_TRACE_ZONE("bounds::transform");
+	for (size_t i = 0; i < in.count; i += 4) {
+		const size_t n = in.count - i < 4 ? in.count - i : 4;
+		transformBoxes(in, out, i, n, toPose(dualquat4::load(poses, i, n)));
+	}
+}
+
+void bounds::transform(const aabb_soa& in, const float* matrices, const aabb_soa& out) {
+	GMATH_TRACE_ZONE("bounds::transform");
+	for (size_t i = 0; i < in.count; i += 4) {
+		const size_t n = in.count - i < 4 ? in.count - i : 4;
+		transformBoxes(in, out, i, n, toPose(matrices + 12 * i, n));
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														frustum
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+frustum frustum::fromMatrix(const mat& viewProjection) {
+	// Gribb and Hartmann: each plane is the last row of the matrix plus or minus another row
+	float rows[4][4];
+	for (uint32_t row = 0; row < 4; row++) {
+		for (uint32_t col = 0; col < 4; col++) {
+			rows[row][col] = viewProjection[col][row];
+		}
+	}
+
+	frustum f;
+	for (int p = 0; p < 6; p++) {
+		const float sign = p % 2 == 0 ? 1.0f : -1.0f;
+		for (int c = 0; c < 4; c++) {
+			f.planes[p][c] = rows[3][c] + sign * rows[p / 2][c];
+		}
+
+		const float n = 1.0f / sqrtf(f.planes[p][0] * f.planes[p][0] + f.planes[p][1] * f.planes[p][1] + f.planes[p][2] * f.planes[p][2]);
+		for (int c = 0; c < 4; c++) {
+			f.planes[p][c] *= n;
+		}
+	}
+
+	return f;
+}
+
+// planes splatted across lanes, along with the absolute normals for boxes
+struct planes4 {
+	__m128 p[6][4];
+	__m128 absNormal[6][3];
+
+	planes4(const frustum& f) {
+		for (int i = 0; i < 6; i++) {
+			for (int c = 0; c < 4; c++) {
+				p[i][c] = _mm_set1_ps(f.planes[i][c]);
+			}
+			for (int c = 0; c < 3; c++) {
+				absNormal[i][c] = _mm_set1_ps(fabsf(f.planes[i][c]));
+			}
+		}
+	}
+};
+
+// mask of the four lanes whose bounds reach inside every plane, radius(i) is the distance the
+// bounds extend from their centers towards the outside of plane i
+template <typename Radius>
+static int insideMask(const planes4& planes, const __m128* center, const Radius& radius) {
+	__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+	for (int i = 0; i < 6; i++) {
+		const __m128* p = planes.p[i];
+		const __m128 distance = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(p[0], center[0]), _mm_mul_ps(p[1], center[1])),
+			_mm_add_ps(_mm_mul_ps(p[2], center[2]), p[3])
+		);
+		inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius(i)), _mm_setzero_ps()));
+	}
+
+	return _mm_movemask_ps(inside);
+}
+
+static int sphereMask(const planes4& planes, const __m128* center, const __m128& radius) {
+	return insideMask(planes, center, [&radius](const int&) { return radius; });
+}
+
+// a box reaches |n| . e past its center towards a plane with normal n
+static int boxMask(const planes4& planes, const __m128* center, const __m128* extent) {
+	return insideMask(planes, center, [&](const int& plane) {
+		const __m128* a = planes.absNormal[plane];
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], extent[0]), _mm_mul_ps(a[1], extent[1])), _mm_mul_ps(a[2], extent[2]));
+	});
+}
+
+// eight bounds per output byte as two groups of four, lanes(i, n) tests bounds i to i + n - 1
+template <typename Lanes>
+static void cullEight(const size_t& count, uint8_t* visible, const Lanes& lanes) {
+	for (size_t i = 0; i < count; i += 8) {
+		int mask = 0;
+		for (size_t half = 0; half < 2; half++) {
+			const size_t j = i + 4 * half;
+			if (j >= count) {
+				break;
+			}
+
+			const size_t n = count - j < 4 ? count - j : 4;
+			mask |= (lanes(j, n) & ((1 << n) - 1)) << (4 * half);
+		}
+		visible[i / 8] = (uint8_t)mask;
+	}
+}
+
+static void loadCenters(float* const* data, const size_t& i, const size_t& n, __m128* center) {
+	for (int c = 0; c < 3; c++) {
+		center[c] = load(data[c], i, n);
+	}
+}
+
+void frustum::cull(const sphere_soa& spheres, uint8_t* visible) const {
+	GMATH_TRACE_ZONE("frustum::cull");
+	const planes4 p(*this);
+	cullEight(spheres.count, visible, [&](const size_t& i, const size_t& n) {
+		__m128 center[3];
+		loadCenters(spheres.data, i, n, center);
+		return sphereMask(p, center, load(spheres.data[3], i, n));
+	});
+}
+
+void frustum::cull(const aabb_soa& boxes, uint8_t* visible) const {
+	GMATH_TRACE_ZONE("frustum::cull");
+	const planes4 p(*this);
+	cullEight(boxes.count, visible, [&](const size_t& i, const size_t& n) {
+		__m128 center[3];
+		__m128 extent[3];
+		loadCenters(boxes.data, i, n, center);
+		loadCenters(boxes.data + 3, i, n, extent);
+		return boxMask(p, center, extent);
+	});
+}
+
+void frustum::cull(const sphere_soa& spheres, const dualquat_soa& poses, uint8_t* visible) const {
+	GMATH_TRACE_ZONE("frustum::cull");
+	const planes4 p(*this);
+	cullEight(spheres.count, visible, [&](const size_t& i, const size_t& n) {
+		__m128 center[3];
+		moveCenters(spheres.data, i, n, toPose(dualquat4::load(poses, i, n)), center);
+		return sphereMask(p, center, load(spheres.data[3], i, n));
+	});
+}
+
+void frustum::cull(const sphere_soa& spheres, const float* matrices, uint8_t* visible) const {
+	GMATH_TRACE_ZONE("frustum::cull");
+	const planes4 p(*this);
+	cullEight(spheres.count, visible, [&](const size_t& i, const size_t& n) {
+		__m128 center[3];
+		moveCenters(spheres.data, i, n, toPose(matrices + 12 * i, n), center);
+		return sphereMask(p, center, load(spheres.data[3], i, n));
+	});
+}
+
+void frustum::cull(const aabb_soa& boxes, const dualquat_soa& poses, uint8_t* visible) const {
+	GMATH_TRACE_ZONE("frustum::cull");
+	const planes4 p(*this);
+	cullEight(boxes.count, visible, [&](const size_t& i, const size_t& n) {
+		const pose4 pose = toPose(dualquat4::load(poses, i, n));
+		__m128 center[3];
+		__m128 extent[3];
+		moveExtents(boxes.data, i, n, pose, extent);
+		moveCenters(boxes.data, i, n, pose, center);
+		return boxMask(p, center, extent);
+	});
+}
+
+void frustum::cull(const aabb_soa& boxes, const float* matrices, uint8_t* visible) const {
+	GMATH_TRACE_ZONE("frustum::cull");
+	const planes4 p(*this);
+	cullEight(boxes.count, visible, [&](const size_t& i, const size_t& n) {
+		const pose4 pose = toPose(matrices + 12 * i, n);
+		__m128 center[3];
+		__m128 extent[3];
+		moveExtents(boxes.data, i, n, pose, extent);
+		moveCenters(boxes.data, i, n, pose, center);
+		return boxMask(p, center, extent);
+	});
+}
\ No newline at end of file
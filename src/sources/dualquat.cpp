@@ -22,6 +22,10 @@ dualquat::dualquat(const dualquat& other):
 	data[1] = quat(other.data[1]);
 }
 
+dualquat::dualquat(const dualquat_view& other):
+	data(new quat[2]{ quat(other.data[0]), quat(other.data[1]) }) {
+}
+
 dualquat::dualquat(dualquat&& other):
 	data(nullptr) {
 	this->data = other.data;
@@ -77,6 +81,17 @@ dualquat dualquat::inverse() const {
 	return dualquat(pInv, -1.0f * (pInv * (q * pInv)));
 }
 
+dualquat dualquat::normalize() const {
+	// scale both parts by the real norm, then remove the component of the
+	// dual part along the real part so that the result is a unit dual quaternion
+	const float n = data[0].norm();
+	const quat r = data[0] / n;
+	const quat d = data[1] / n;
+	const float rd = r[0] * d[0] + r[1] * d[1] + r[2] * d[2] + r[3] * d[3];
+
+	return dualquat(r, d - rd * r);
+}
+
 vec4 dualquat::transform(const vec4& v) const {
 	const dualquat d = v[3] == 0.0f ? dualquat(data[0], quat()) : *this;
 	const dualquat result = d * (dualquat(v) * d.dualConjugate());
@@ -88,6 +103,36 @@ vec4 dualquat::transform(const vec4& v) const {
 	);
 }
 
+vec4 dualquat::transform(const vec4_view& v) const {
+	return dualquat_view(*this).transform(v);
+}
+
+void dualquat::transform(const vec4_span& in, const vec4_span& out) const {
+	GMATH_TRACE_ZONE("dualquat::transform");
+	// same result as transforming each point on its own, but the rotation matrix
+	// and translation are built once for the whole span
+	const quat& r = data[0];
+	const float w = r[0], x = r[1], y = r[2], z = r[3];
+	const __m128 col1 = _mm_set_ps(0.0f, 2.0f * (x * z - w * y), 2.0f * (x * y + w * z), 1.0f - 2.0f * (y * y + z * z));
+	const __m128 col2 = _mm_set_ps(0.0f, 2.0f * (y * z + w * x), 1.0f - 2.0f * (x * x + z * z), 2.0f * (x * y - w * z));
+	const __m128 col3 = _mm_set_ps(0.0f, 1.0f - 2.0f * (x * x + y * y), 2.0f * (y * z - w * x), 2.0f * (x * z + w * y));
+	const quat t = 2.0f * (data[1] * r.conjugate());
+	const __m128 translation = _mm_set_ps(0.0f, t[3], t[2], t[1]);
+	const __m128 wMask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+
+	for (size_t i = 0; i < in.size(); i++) {
+		const vec4_view src = in[i];
+		const __m128 v = src.load();
+		const __m128 isPoint = _mm_cmpneq_ps(_mm_replicate_w_ps(v), _mm_setzero_ps());
+		const __m128 rotated = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(col1, _mm_replicate_x_ps(v)), _mm_mul_ps(col2, _mm_replicate_y_ps(v))),
+			_mm_mul_ps(col3, _mm_replicate_z_ps(v))
+		);
+		const __m128 moved = _mm_add_ps(rotated, _mm_and_ps(isPoint, translation));
+		out[i].store(_mm_or_ps(_mm_andnot_ps(wMask, moved), _mm_and_ps(wMask, v)));
+	}
+}
+
 std::string dualquat::toString() const {
 	return std::string("non-dual: ") + data[0].toString() + std::string("\n") +
 		std::string("dual: ") + data[1].toString();
@@ -114,4 +159,60 @@ dualquat gmath::operator+(const dualquat& d1, const dualquat& d2) {
 
 dualquat gmath::operator-(const dualquat& d1, const dualquat& d2) {
 	return dualquat(d1.data[0] - d2.data[0], d1.data[1] - d2.data[1]);
-}
\ No newline at end of file
+}
+
+// lanes past the end of a batch read from here so the tail can share the 4 wide path
+alignas(16) static const float zeroLane[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+void dualquat::fromAxisAngle(const vec4* axes, const float* radians, const vec4* translations, dualquat* out, const size_t& count, const trigAccuracy& accuracy) {
+	GMATH_TRACE_ZONE("dualquat::fromAxisAngle");
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	for (size_t i = 0; i < count; i += 4) {
+		const size_t n = count - i < 4 ? count - i : 4;
+
+		float angles[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (size_t k = 0; k < n; k++) {
+			angles[k] = radians[i + k];
+		}
+
+		__m128 s;
+		__m128 c;
+		trig::sincos(_mm_mul_ps(_mm_loadu_ps(angles), half), s, c, accuracy);
+
+		__m128 ax = _mm_load_ps(axes[i].data);
+		__m128 ay = _mm_load_ps(n > 1 ? axes[i + 1].data : zeroLane);
+		__m128 az = _mm_load_ps(n > 2 ? axes[i + 2].data : zeroLane);
+		__m128 aw = _mm_load_ps(n > 3 ? axes[i + 3].data : zeroLane);
+		_MM_TRANSPOSE4_PS(ax, ay, az, aw);
+
+		__m128 tx = _mm_load_ps(translations[i].data);
+		__m128 ty = _mm_load_ps(n > 1 ? translations[i + 1].data : zeroLane);
+		__m128 tz = _mm_load_ps(n > 2 ? translations[i + 2].data : zeroLane);
+		__m128 tw = _mm_load_ps(n > 3 ? translations[i + 3].data : zeroLane);
+		_MM_TRANSPOSE4_PS(tx, ty, tz, tw);
+
+		// real part (w, v)
+		__m128 rw = c;
+		__m128 rx = _mm_mul_ps(ax, s);
+		__m128 ry = _mm_mul_ps(ay, s);
+		__m128 rz = _mm_mul_ps(az, s);
+
+		// dual part 0.5 * (0, t) * (w, v) = 0.5 * (-t.v, w t + t x v)
+		const __m128 tDotV = _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, rx), _mm_mul_ps(ty, ry)), _mm_mul_ps(tz, rz));
+		__m128 dw = _mm_mul_ps(half, _mm_sub_ps(_mm_setzero_ps(), tDotV));
+		__m128 dx = _mm_mul_ps(half, _mm_add_ps(_mm_mul_ps(rw, tx), _mm_sub_ps(_mm_mul_ps(ty, rz), _mm_mul_ps(tz, ry))));
+		__m128 dy = _mm_mul_ps(half, _mm_add_ps(_mm_mul_ps(rw, ty), _mm_sub_ps(_mm_mul_ps(tz, rx), _mm_mul_ps(tx, rz))));
+		__m128 dz = _mm_mul_ps(half, _mm_add_ps(_mm_mul_ps(rw, tz), _mm_sub_ps(_mm_mul_ps(tx, ry), _mm_mul_ps(ty, rx))));
+
+		_MM_TRANSPOSE4_PS(rw, rx, ry, rz);
+		_MM_TRANSPOSE4_PS(dw, dx, dy, dz);
+
+		const __m128 real[4] = { rw, rx, ry, rz };
+		const __m128 dual[4] = { dw, dx, dy, dz };
+		for (size_t k = 0; k < n; k++) {
+			_mm_store_ps(out[i + k].data[0].data, real[k]);
+			_mm_store_ps(out[i + k].data[1].data, dual[k]);
+		}
+	}
+}
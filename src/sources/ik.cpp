@@ -0,0 +1,309 @@
+#include "..\include\gmath.hpp"
+
+#include <thread>
+#include <vector>
+
+using namespace gmath;
+
+// x, y, z of four vectors, one per lane
+struct vec3x4 {
+	__m128 x;
+	__m128 y;
+	__m128 z;
+};
+
+static vec3x4 load(float* const* v, const size_t& i, const size_t& n) {
+	vec3x4 result;
+	__m128* lanes[3] = { &result.x, &result.y, &result.z };
+	for (int c = 0; c < 3; c++) {
+		if (n == 4) {
+			*lanes[c] = _mm_loadu_ps(v[c] + i);
+		}
+		else {
+			float values[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (size_t k = 0; k < n; k++) {
+				values[k] = v[c][i + k];
+			}
+			*lanes[c] = _mm_loadu_ps(values);
+		}
+	}
+
+	return result;
+}
+
+static vec3x4 operator+(const vec3x4& a, const vec3x4& b) {
+	return vec3x4{ _mm_add_ps(a.x, b.x), _mm_add_ps(a.y, b.y), _mm_add_ps(a.z, b.z) };
+}
+
+static vec3x4 operator-(const vec3x4& a, const vec3x4& b) {
+	return vec3x4{ _mm_sub_ps(a.x, b.x), _mm_sub_ps(a.y, b.y), _mm_sub_ps(a.z, b.z) };
+}
+
+static vec3x4 operator*(const __m128& s, const vec3x4& v) {
+	return vec3x4{ _mm_mul_ps(s, v.x), _mm_mul_ps(s, v.y), _mm_mul_ps(s, v.z) };
+}
+
+static __m128 dot(const vec3x4& a, const vec3x4& b) {
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z));
+}
+
+static vec3x4 cross(const vec3x4& a, const vec3x4& b) {
+	return vec3x4{
+		_mm_sub_ps(_mm_mul_ps(a.y, b.z), _mm_mul_ps(a.z, b.y)),
+		_mm_sub_ps(_mm_mul_ps(a.z, b.x), _mm_mul_ps(a.x, b.z)),
+		_mm_sub_ps(_mm_mul_ps(a.x, b.y), _mm_mul_ps(a.y, b.x))
+	};
+}
+
+static __m128 select(const __m128& mask, const __m128& a, const __m128& b) {
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// lanes set in mask take a, the others b
+static quat4 select(const __m128& mask, const quat4& a, const quat4& b) {
+	return quat4{ { select(mask, a.data[0], b.data[0]), select(mask, a.data[1], b.data[1]), select(mask, a.data[2], b.data[2]), select(mask, a.data[3], b.data[3]) } };
+}
+
+// v rotated by the unit quaternions q, v + 2 w (u x v) + 2 u x (u x v)
+static vec3x4 rotate(const quat4& q, const vec3x4& v) {
+	const vec3x4 u{ q.data[1], q.data[2], q.data[3] };
+	const vec3x4 uv = cross(u, v);
+	const vec3x4 uuv = cross(u, uv);
+	const __m128 two = _mm_set1_ps(2.0f);
+	return v + (two * (q.data[0] * uv + uuv));
+}
+
+// shortest arc turning direction a onto direction b, neither needs to be unit length
+static quat4 fromTo(const vec3x4& a, const vec3x4& b) {
+	const vec3x4 axis = cross(a, b);
+	const __m128 w = _mm_add_ps(_mm_sqrt_ps(_mm_mul_ps(dot(a, a), dot(b, b))), dot(a, b));
+	quat4 q{ { w, axis.x, axis.y, axis.z } };
+
+	// opposite directions: half turn about any axis perpendicular to a
+	const __m128 epsilon = _mm_set1_ps(1e-6f);
+	const __m128 opposite = _mm_cmple_ps(w, _mm_mul_ps(epsilon, _mm_sqrt_ps(_mm_mul_ps(dot(a, a), dot(b, b)))));
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	const __m128 useY = _mm_cmpgt_ps(_mm_and_ps(a.x, absMask), _mm_and_ps(a.z, absMask));
+	// a x (0, 1, 0) = (-a.z, 0, a.x), a x (0, 0, 1) = (a.y, -a.x, 0)
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 sign = _mm_set1_ps(-0.0f);
+	const quat4 half{ {
+		zero,
+		select(useY, _mm_xor_ps(a.z, sign), a.y),
+		select(useY, zero, _mm_xor_ps(a.x, sign)),
+		select(useY, a.x, zero)
+	} };
+	q = select(opposite, half, q);
+
+	// zero length inputs leave the joint alone
+	const __m128 degenerate = _mm_cmple_ps(q.norm2(), _mm_set1_ps(1e-30f));
+	q.data[0] = select(degenerate, _mm_set1_ps(1.0f), q.data[0]);
+	return q.normalize();
+}
+
+// scratch for one group of four chains
+struct chainState {
+	std::vector<vec3x4> offsets;
+	std::vector<quat4> local;
+	std::vector<quat4> world;
+	std::vector<vec3x4> positions;
+	// joint positions solved by fabrik
+	std::vector<vec3x4> reached;
+	quat4 rootRotation;
+	vec3x4 rootPosition;
+	vec3x4 target;
+	uint32_t joints;
+
+	chainState(const uint32_t& joints):
+		offsets(joints), local(joints), world(joints), positions(joints + 1), reached(joints + 1), joints(joints) {
+	}
+
+	// world rotations and positions from joint first on
+	void forward(const uint32_t& first) {
+		if (first == 0) {
+			positions[0] = rootPosition;
+		}
+		for (uint32_t j = first; j < joints; j++) {
+			world[j] = (j == 0 ? rootRotation : world[j - 1]) * local[j];
+			positions[j + 1] = positions[j] + rotate(world[j], offsets[j]);
+		}
+	}
+
+	const quat4& parent(const uint32_t& j) const {
+		return j == 0 ? rootRotation : world[j - 1];
+	}
+
+	// applies the world space turn to joint j as a local rotation
+	void turn(const uint32_t& j, const quat4& turn, const __m128& frozen, const size_t& chain, const ikOptions& options) {
+		const quat4 rotated = (parent(j).conjugate() * (turn * world[j])).normalize();
+		quat4 limited = rotated;
+		if (options.limit) {
+			options.limit(j, chain, limited);
+		}
+		local[j] = select(frozen, local[j], limited);
+	}
+};
+
+static void ccd(chainState& s, const __m128& frozen, const size_t& chain, const ikOptions& options) {
+	for (uint32_t j = s.joints; j-- > 0;) {
+		const vec3x4 toEnd = s.positions[s.joints] - s.positions[j];
+		const vec3x4 toTarget = s.target - s.positions[j];
+		s.turn(j, fromTo(toEnd, toTarget), frozen, chain, options);
+		s.forward(j);
+	}
+}
+
+static vec3x4 reach(const vec3x4& from, const vec3x4& towards, const __m128& length) {
+	const vec3x4 d = towards - from;
+	const __m128 n2 = dot(d, d);
+	// coincident joints keep their distance along no particular direction, leave them in place
+	const __m128 scale = select(_mm_cmpgt_ps(n2, _mm_set1_ps(1e-30f)), _mm_div_ps(length, _mm_sqrt_ps(n2)), _mm_setzero_ps());
+	return from + (scale * d);
+}
+
+static void fabrik(chainState& s, const __m128& frozen, const size_t& chain, const ikOptions& options) {
+	std::vector<vec3x4>& p = s.reached;
+	p = s.positions;
+	p[s.joints] = s.target;
+	for (uint32_t j = s.joints; j-- > 0;) {
+		p[j] = reach(p[j + 1], p[j], _mm_sqrt_ps(dot(s.offsets[j], s.offsets[j])));
+	}
+	p[0] = s.rootPosition;
+	for (uint32_t j = 0; j < s.joints; j++) {
+		p[j + 1] = reach(p[j], p[j + 1], _mm_sqrt_ps(dot(s.offsets[j], s.offsets[j])));
+	}
+
+	// turn each bone onto the solved direction, following the limited chain rather than p
+	for (uint32_t j = 0; j < s.joints; j++) {
+		const vec3x4 bone = s.positions[j + 1] - s.positions[j];
+		s.turn(j, fromTo(bone, p[j + 1] - s.positions[j]), frozen, chain, options);
+		s.forward(j);
+	}
+}
+
+// solves chains first to last - 1, returns how many reached tolerance
+static size_t solveRange(const ikChains& chains, const size_t& first, const size_t& last, const ikOptions& options) {
+	chainState s(chains.joints);
+	const quat_soa rotations = chains.rotations;
+	const __m128 tolerance2 = _mm_set1_ps(options.tolerance * options.tolerance);
+	size_t converged = 0;
+
+	for (size_t i = first; i < last; i += 4) {
+		const size_t n = last - i < 4 ? last - i : 4;
+		for (uint32_t j = 0; j < chains.joints; j++) {
+			s.local[j] = quat4::load(rotations, j * chains.count + i, n);
+			s.offsets[j] = load(chains.offsets, j * chains.count + i, n);
+		}
+
+		const dualquat4 root = dualquat4::load(chains.roots, i, n);
+		s.rootRotation = root.data[0];
+		const quat4 t = _mm_set1_ps(2.0f) * (root.data[1] * root.data[0].conjugate());
+		s.rootPosition = vec3x4{ t.data[1], t.data[2], t.data[3] };
+		s.target = load(chains.targets, i, n);
+
+		// lanes past the end of the batch count as done from the start
+		const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+		const __m128 padding = _mm_cmpge_ps(lane, _mm_set1_ps((float)n));
+		__m128 done = padding;
+		s.forward(0);
+		for (uint32_t iteration = 0; iteration <= options.iterations; iteration++) {
+			const vec3x4 miss = s.positions[chains.joints] - s.target;
+			done = _mm_or_ps(done, _mm_cmple_ps(dot(miss, miss), tolerance2));
+			if (_mm_movemask_ps(done) == 0xf || iteration == options.iterations) {
+				break;
+			}
+
+			if (options.method == ikMethod::ccd) {
+				ccd(s, done, i, options);
+			}
+			else {
+				fabrik(s, done, i, options);
+			}
+		}
+
+		const int reached = _mm_movemask_ps(_mm_andnot_ps(padding, done));
+		converged += (reached & 1) + ((reached >> 1) & 1) + ((reached >> 2) & 1) + ((reached >> 3) & 1);
+		for (uint32_t j = 0; j < chains.joints; j++) {
+			s.local[j].store(rotations, j * chains.count + i, n);
+		}
+	}
+
+	return converged;
+}
+
+size_t ik::solve(const ikChains& chains, const ikOptions& options) {
+	GMATH_TRACE_ZONE("ik::solve");
+	const size_t groups = (chains.count + 3) / 4;
+	const size_t minGroups = (options.minChainsPerThread + 3) / 4;
+	size_t threads = options.threads != 0 ? options.threads : std::thread::hardware_concurrency();
+	const size_t useful = minGroups > 0 ? (groups + minGroups - 1) / minGroups : groups;
+	threads = threads < useful ? threads : useful;
+	threads = threads > 0 ? threads : 1;
+
+	// whole groups of four per thread so no two threads share a register's chains
+	std::vector<size_t> converged(threads, 0);
+	const auto work = [&](const size_t t) {
+		GMATH_TRACE_ZONE("ik chains");
+		const size_t first = groups * t / threads * 4;
+		size_t last = groups * (t + 1) / threads * 4;
+		last = last < chains.count ? last : chains.count;
+		converged[t] = solveRange(chains, first, last, options);
+	};
+
+	std::vector<std::thread> workers;
+	for (size_t t = 1; t < threads; t++) {
+		workers.emplace_back(work, t);
+	}
+	work(0);
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	size_t total = 0;
+	for (const size_t c : converged) {
+		total += c;
+	}
+
+	return total;
+}
+
+void ik::clampAngle(quat4& rotation, const float& maxRadians) {
+	// q and -q are the same rotation, use the one with the smaller angle
+	const __m128 sign = _mm_set1_ps(-0.0f);
+	const __m128 flip = _mm_and_ps(rotation.data[0], sign);
+	for (int c = 0; c < 4; c++) {
+		rotation.data[c] = _mm_xor_ps(rotation.data[c], flip);
+	}
+
+	const vec3x4 v{ rotation.data[1], rotation.data[2], rotation.data[3] };
+	const __m128 s = _mm_sqrt_ps(dot(v, v));
+	const float limit = sinf(0.5f * maxRadians);
+	const __m128 over = _mm_cmpgt_ps(s, _mm_set1_ps(limit));
+	const __m128 scale = _mm_div_ps(_mm_set1_ps(limit), s);
+	for (int c = 1; c < 4; c++) {
+		rotation.data[c] = select(over, _mm_mul_ps(rotation.data[c], scale), rotation.data[c]);
+	}
+	rotation.data[0] = select(over, _mm_set1_ps(cosf(0.5f * maxRadians)), rotation.data[0]);
+}
+
+void ik::hinge(quat4& rotation, const vec4& axis, const float& minRadians, const float& maxRadians) {
+	const float n = 1.0f / sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	const vec3x4 a{ _mm_set1_ps(axis[0] * n), _mm_set1_ps(axis[1] * n), _mm_set1_ps(axis[2] * n) };
+
+	// twist about the axis, with a non negative real part so the half angle is in [-pi / 2, pi / 2]
+	const vec3x4 v{ rotation.data[1], rotation.data[2], rotation.data[3] };
+	const __m128 sign = _mm_set1_ps(-0.0f);
+	const __m128 flip = _mm_and_ps(rotation.data[0], sign);
+	const __m128 w = _mm_xor_ps(rotation.data[0], flip);
+	const __m128 s = _mm_xor_ps(dot(v, a), flip);
+	const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(w, w), _mm_mul_ps(s, s)));
+	const __m128 degenerate = _mm_cmple_ps(length, _mm_set1_ps(1e-12f));
+
+	// sin of the half angle is monotonic there, so clamping it clamps the angle
+	__m128 sinHalf = select(degenerate, _mm_setzero_ps(), _mm_div_ps(s, length));
+	sinHalf = _mm_max_ps(sinHalf, _mm_set1_ps(sinf(0.5f * minRadians)));
+	sinHalf = _mm_min_ps(sinHalf, _mm_set1_ps(sinf(0.5f * maxRadians)));
+	const __m128 cosHalf = _mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(sinHalf, sinHalf)));
+
+	rotation = quat4{ { cosHalf, _mm_mul_ps(sinHalf, a.x), _mm_mul_ps(sinHalf, a.y), _mm_mul_ps(sinHalf, a.z) } };
+}
\ No newline at end of file
@@ -0,0 +1,507 @@
+#include "..\include\gmath.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace gmath;
+
+// unit dual quaternion held in registers as (real, i, j, k)
+struct pose {
+	__m128 real;
+	__m128 dual;
+};
+
+static float dot(const __m128& a, const __m128& b) {
+	float lanes[4];
+	_mm_storeu_ps(lanes, _mm_mul_ps(a, b));
+	return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+static __m128 conjugate(const __m128& q) {
+	return _mm_xor_ps(q, _mm_set_ps(-0.0f, -0.0f, -0.0f, 0.0f));
+}
+
+static pose multiply(const pose& a, const pose& b) {
+	return pose{
+		quat::multiply(a.real, b.real),
+		_mm_add_ps(quat::multiply(a.real, b.dual), quat::multiply(a.dual, b.real))
+	};
+}
+
+// translation as (0, x, y, z)
+static __m128 translationOf(const pose& p) {
+	const __m128 t = quat::multiply(p.dual, conjugate(p.real));
+	return _mm_add_ps(t, t);
+}
+
+static pose normalize(const pose& p) {
+	const __m128 n = _mm_set1_ps(1.0f / sqrtf(dot(p.real, p.real)));
+	const __m128 r = _mm_mul_ps(p.real, n);
+	const __m128 d = _mm_mul_ps(p.dual, n);
+	return pose{ r, _mm_sub_ps(d, _mm_mul_ps(_mm_set1_ps(dot(r, d)), r)) };
+}
+
+static pose load(const dualquat_soa& soa, const size_t& i) {
+	return pose{
+		_mm_set_ps(soa.data[3][i], soa.data[2][i], soa.data[1][i], soa.data[0][i]),
+		_mm_set_ps(soa.data[7][i], soa.data[6][i], soa.data[5][i], soa.data[4][i])
+	};
+}
+
+static void store(const dualquat_soa& soa, const size_t& i, const pose& p) {
+	float lanes[8];
+	_mm_storeu_ps(lanes, p.real);
+	_mm_storeu_ps(lanes + 4, p.dual);
+	for (int c = 0; c < 8; c++) {
+		soa.data[c][i] = lanes[c];
+	}
+}
+
+static pose load(const float* data) {
+	return pose{ _mm_loadu_ps(data), _mm_loadu_ps(data + 4) };
+}
+
+static void store(float* data, const pose& p) {
+	_mm_storeu_ps(data, p.real);
+	_mm_storeu_ps(data + 4, p.dual);
+}
+
+// error of p against the sample s as a fraction of the tolerances, above 1 is out of tolerance
+static float error(const pose& p, const pose& s, const keyReduceOptions& options) {
+	// q and -q are the same rotation, compare against the nearer one
+	const __m128 flip = dot(p.real, s.real) < 0.0f ? _mm_set1_ps(-0.0f) : _mm_setzero_ps();
+	const __m128 chord = _mm_sub_ps(p.real, _mm_xor_ps(s.real, flip));
+	// angle between the rotations from the chord, better conditioned than acos near zero
+	const float halfChord = 0.5f * sqrtf(dot(chord, chord));
+	const float angle = 4.0f * asinf(halfChord < 1.0f ? halfChord : 1.0f);
+
+	const __m128 dt = _mm_sub_ps(translationOf(p), translationOf(s));
+	const float distance = sqrtf(dot(dt, dt));
+
+	const float tiny = 1e-30f;
+	return std::max(distance / std::max(options.positionTolerance, tiny), angle / std::max(options.angleTolerance, tiny));
+}
+
+// interpolates between two keys, with the screw parameters of the sclerp precomputed
+class segment {
+public:
+	segment(const float& t0, const pose& a, const float& t1, const pose& b, const keyInterpolation& interpolation):
+		t0(t0), span(t1 - t0), a(a), b(b), blend(true) {
+		// take the short way round
+		if (dot(a.real, b.real) < 0.0f) {
+			const __m128 sign = _mm_set1_ps(-0.0f);
+			this->b.real = _mm_xor_ps(b.real, sign);
+			this->b.dual = _mm_xor_ps(b.dual, sign);
+		}
+		if (interpolation == keyInterpolation::sclerp) {
+			screw();
+		}
+	}
+
+	pose at(const float& t) const {
+		float u = span > 0.0f ? (t - t0) / span : 0.0f;
+		u = u < 0.0f ? 0.0f : (u > 1.0f ? 1.0f : u);
+
+		if (blend) {
+			const __m128 wa = _mm_set1_ps(1.0f - u);
+			const __m128 wb = _mm_set1_ps(u);
+			return normalize(pose{
+				_mm_add_ps(_mm_mul_ps(wa, a.real), _mm_mul_ps(wb, b.real)),
+				_mm_add_ps(_mm_mul_ps(wa, a.dual), _mm_mul_ps(wb, b.dual))
+			});
+		}
+
+		// (a^-1 b)^u as a screw of u theta about the same axis with u times the pitch
+		const float h = 0.5f * u * theta;
+		const float s = sinf(h);
+		const float c = cosf(h);
+		const float d = u * pitch;
+		const __m128 real = _mm_add_ps(_mm_set_ss(c), _mm_mul_ps(_mm_set1_ps(s), axis));
+		const __m128 dual = _mm_add_ps(
+			_mm_set_ss(-0.5f * d * s),
+			_mm_add_ps(_mm_mul_ps(_mm_set1_ps(s), moment), _mm_mul_ps(_mm_set1_ps(0.5f * d * c), axis))
+		);
+		return multiply(a, pose{ real, dual });
+	}
+
+private:
+	void screw() {
+		const pose delta = multiply(pose{ conjugate(a.real), conjugate(a.dual) }, b);
+		float r[4];
+		float d[4];
+		_mm_storeu_ps(r, delta.real);
+		_mm_storeu_ps(d, delta.dual);
+
+		// for tiny rotations the screw axis is ill defined and the blend is as good
+		const float s = sqrtf(r[1] * r[1] + r[2] * r[2] + r[3] * r[3]);
+		if (s < 1e-4f) {
+			return;
+		}
+
+		blend = false;
+		theta = 2.0f * atan2f(s, r[0]);
+		pitch = -2.0f * d[0] / s;
+		axis = _mm_mul_ps(_mm_set_ps(r[3], r[2], r[1], 0.0f), _mm_set1_ps(1.0f / s));
+		moment = _mm_mul_ps(
+			_mm_sub_ps(_mm_set_ps(d[3], d[2], d[1], 0.0f), _mm_mul_ps(_mm_set1_ps(0.5f * pitch * r[0]), axis)),
+			_mm_set1_ps(1.0f / s)
+		);
+	}
+
+	float t0;
+	float span;
+	pose a;
+	pose b;
+	bool blend;
+	float theta = 0.0f;
+	float pitch = 0.0f;
+	__m128 axis;
+	__m128 moment;
+};
+
+// true when the span between samples first and last reconstructs every sample inside it
+static bool spanFits(const keyTrack& track, const size_t& first, const size_t& last, const keyReduceOptions& options) {
+	const segment s(track.times[first], load(track.samples, first), track.times[last], load(track.samples, last), options.interpolation);
+	for (size_t i = first + 1; i < last; i++) {
+		if (error(s.at(track.times[i]), load(track.samples, i), options) > 1.0f) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// largest error of the span from key value a at sample first to key value b at sample last
+static float spanError(const keyTrack& track, const float* a, const float* b, const size_t& first, const size_t& last, const keyReduceOptions& options) {
+	const segment s(track.times[first], load(a), track.times[last], load(b), options.interpolation);
+	float worst = 0.0f;
+	for (size_t i = first; i <= last; i++) {
+		worst = std::max(worst, error(s.at(track.times[i]), load(track.samples, i), options));
+	}
+
+	return worst;
+}
+
+// Drops more keys by moving their neighbours off the samples. For each interior key the two
+// keys around it are refit by least squares to every sample they influence, with the keys
+// beyond them held fixed, as nodes of a piecewise linear curve. The key is dropped when the
+// three affected spans stay in tolerance. The first and last keys are pinned to their samples.
+static void refit(const keyTrack& track, std::vector<size_t>& keys, std::vector<float>& values, const keyReduceOptions& options) {
+	const size_t n = track.samples.count;
+
+	// samples flipped onto one hemisphere so they can be averaged
+	std::vector<float> x(8 * n);
+	for (size_t i = 0; i < n; i++) {
+		float sign = 1.0f;
+		if (i > 0) {
+			float d = 0.0f;
+			for (int c = 0; c < 4; c++) {
+				d += x[8 * (i - 1) + c] * track.samples.data[c][i];
+			}
+			sign = d < 0.0f ? -1.0f : 1.0f;
+		}
+		for (int c = 0; c < 8; c++) {
+			x[8 * i + c] = sign * track.samples.data[c][i];
+		}
+	}
+	for (size_t k = 0; k < keys.size(); k++) {
+		std::copy(&x[8 * keys[k]], &x[8 * keys[k]] + 8, &values[8 * k]);
+	}
+
+	size_t k = 1;
+	while (k + 1 < keys.size()) {
+		const size_t p = k - 1;
+		const size_t q = k + 1;
+		const size_t first = p > 0 ? keys[p - 1] : keys[p];
+		const size_t last = q + 1 < keys.size() ? keys[q + 1] : keys[q];
+
+		// 2 x 2 normal equations for the values at p and q, one right hand side per component
+		double a = 0.0, b = 0.0, c = 0.0;
+		double rp[8] = {};
+		double rq[8] = {};
+		for (size_t i = first; i <= last; i++) {
+			double wp = 0.0, wq = 0.0;
+			const float* fixed = nullptr;
+			double wFixed = 0.0;
+			const double t = track.times[i];
+			if (i < keys[p]) {
+				wp = (t - track.times[first]) / ((double)track.times[keys[p]] - track.times[first]);
+				fixed = &values[8 * (p - 1)];
+				wFixed = 1.0 - wp;
+			}
+			else if (i <= keys[q]) {
+				wq = (t - track.times[keys[p]]) / ((double)track.times[keys[q]] - track.times[keys[p]]);
+				wp = 1.0 - wq;
+			}
+			else {
+				wFixed = (t - track.times[keys[q]]) / ((double)track.times[last] - track.times[keys[q]]);
+				fixed = &values[8 * (q + 1)];
+				wq = 1.0 - wFixed;
+			}
+
+			a += wp * wp;
+			b += wp * wq;
+			c += wq * wq;
+			for (int j = 0; j < 8; j++) {
+				const double target = x[8 * i + j] - (fixed != nullptr ? wFixed * fixed[j] : 0.0);
+				rp[j] += wp * target;
+				rq[j] += wq * target;
+			}
+		}
+
+		// a pinned end key moves to the right hand side, leaving one unknown or none
+		const bool pinP = p == 0;
+		const bool pinQ = q + 1 == keys.size();
+		float fitted[16];
+		std::copy(&values[8 * p], &values[8 * p] + 8, fitted);
+		std::copy(&values[8 * q], &values[8 * q] + 8, fitted + 8);
+		const double det = a * c - b * b;
+		for (int j = 0; j < 8; j++) {
+			if (!pinP && !pinQ) {
+				fitted[j] = (float)((c * rp[j] - b * rq[j]) / det);
+				fitted[8 + j] = (float)((a * rq[j] - b * rp[j]) / det);
+			}
+			else if (!pinP) {
+				fitted[j] = (float)((rp[j] - b * fitted[8 + j]) / a);
+			}
+			else if (!pinQ) {
+				fitted[8 + j] = (float)((rq[j] - b * fitted[j]) / c);
+			}
+		}
+		if (!pinP) {
+			store(fitted, normalize(load(fitted)));
+		}
+		if (!pinQ) {
+			store(fitted + 8, normalize(load(fitted + 8)));
+		}
+
+		const bool fits =
+			(p == 0 || spanError(track, &values[8 * (p - 1)], fitted, first, keys[p], options) <= 1.0f) &&
+			spanError(track, fitted, fitted + 8, keys[p], keys[q], options) <= 1.0f &&
+			(q + 1 == keys.size() || spanError(track, fitted + 8, &values[8 * (q + 1)], keys[q], last, options) <= 1.0f);
+		if (fits) {
+			std::copy(fitted, fitted + 8, &values[8 * p]);
+			std::copy(fitted + 8, fitted + 16, &values[8 * q]);
+			keys.erase(keys.begin() + k);
+			values.erase(values.begin() + 8 * k, values.begin() + 8 * (k + 1));
+		}
+		else {
+			k++;
+		}
+	}
+
+	// the ends were fitted on the flipped copies, hand back the samples themselves
+	store(&values[0], load(track.samples, keys.front()));
+	store(&values[8 * (keys.size() - 1)], load(track.samples, keys.back()));
+}
+
+static void reduceTrack(keyTrack& track, const keyReduceOptions& options) {
+	const size_t n = track.samples.count;
+	std::vector<size_t> keys;
+	if (n <= 2) {
+		for (size_t i = 0; i < n; i++) {
+			keys.push_back(i);
+		}
+	}
+	else {
+		// each span runs from the last key as far as it stays in tolerance, found by doubling
+		// the span until it fails and then bisecting, so long holds cost O(length log length)
+		keys.push_back(0);
+		size_t anchor = 0;
+		while (anchor < n - 1) {
+			size_t good = anchor + 1;
+			size_t bad = n;
+			for (size_t step = 1; good < n - 1; step *= 2) {
+				const size_t end = std::min(good + step, n - 1);
+				if (!spanFits(track, anchor, end, options)) {
+					bad = end;
+					break;
+				}
+				good = end;
+			}
+			while (bad < n && bad - good > 1) {
+				const size_t middle = good + (bad - good) / 2;
+				if (spanFits(track, anchor, middle, options)) {
+					good = middle;
+				}
+				else {
+					bad = middle;
+				}
+			}
+
+			keys.push_back(good);
+			anchor = good;
+		}
+	}
+
+	std::vector<float> values(8 * keys.size());
+	if (options.refit && keys.size() > 2) {
+		refit(track, keys, values, options);
+	}
+	else {
+		for (size_t k = 0; k < keys.size(); k++) {
+			store(&values[8 * k], load(track.samples, keys[k]));
+		}
+	}
+
+	track.keyCount = keys.size();
+	for (size_t k = 0; k < keys.size(); k++) {
+		track.keyTimes[k] = track.times[keys[k]];
+		store(track.keys, k, load(&values[8 * k]));
+		if (track.keyIndices != nullptr) {
+			track.keyIndices[k] = (uint32_t)keys[k];
+		}
+	}
+}
+
+void keyframes::reduce(keyTrack& track, const keyReduceOptions& options) {
+	GMATH_TRACE_ZONE("keyframes::reduce");
+	reduceTrack(track, options);
+}
+
+void keyframes::reduce(keyTrack* tracks, const size_t& count, const keyReduceOptions& options) {
+	GMATH_TRACE_ZONE("keyframes::reduce");
+	size_t threads = options.threads != 0 ? options.threads : std::thread::hardware_concurrency();
+	threads = threads < count ? threads : count;
+	threads = threads > 0 ? threads : 1;
+
+	// tracks differ a lot in length, so threads take the next track as they finish
+	std::atomic<size_t> next(0);
+	const auto work = [&]() {
+		GMATH_TRACE_ZONE("keyframes tracks");
+		for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+			reduceTrack(tracks[i], options);
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (size_t t = 1; t < threads; t++) {
+		workers.emplace_back(work);
+	}
+	work();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+void keyframes::sample(
+	const float* keyTimes,
+	const dualquat_soa& keys,
+	const float* times,
+	const dualquat_soa& out,
+	const keyInterpolation& interpolation
+) {
+	GMATH_TRACE_ZONE("keyframes::sample");
+	if (keys.count == 0) {
+		return;
+	}
+
+	for (size_t i = 0; i < out.count; i++) {
+		// key at or before the time, clamped so the segment always has two keys
+		const size_t upper = std::upper_bound(keyTimes, keyTimes + keys.count, times[i]) - keyTimes;
+		if (keys.count == 1 || upper == 0) {
+			store(out, i, load(keys, 0));
+			continue;
+		}
+
+		const size_t k = std::min(upper, keys.count - 1) - 1;
+		const segment s(keyTimes[k], load(keys, k), keyTimes[k + 1], load(keys, k + 1), interpolation);
+		store(out, i, s.at(times[i]));
+	}
+}
+
+keyStream::keyStream(const keyReduceOptions& options, const size_t& window):
+	options(options),
+	window(window < 2 ? 2 : window),
+	buffered(0),
+	anchored(false),
+	anchorTime(0.0f),
+	times(nullptr),
+	poses(nullptr) {
+	times = new float[this->window];
+	poses = new float[8 * this->window];
+}
+
+keyStream::~keyStream() {
+	delete[] times;
+	delete[] poses;
+	times = nullptr;
+	poses = nullptr;
+}
+
+static void write(const pose& p, const dualquat_view& out) {
+	out[0].store(p.real);
+	out[1].store(p.dual);
+}
+
+bool keyStream::push(const float& time, const dualquat_view& sample, float& keyTime, const dualquat_view& key) {
+	const pose p{ sample[0].load(), sample[1].load() };
+
+	// the first sample is always a key
+	if (!anchored) {
+		anchored = true;
+		anchorTime = time;
+		store(anchor, p);
+		keyTime = time;
+		write(p, key);
+		return true;
+	}
+
+	// can the span from the last key reach this sample?
+	bool fits = true;
+	if (buffered > 0) {
+		const segment s(anchorTime, load(anchor), time, p, options.interpolation);
+		for (size_t i = 0; i < buffered && fits; i++) {
+			fits = error(s.at(times[i]), load(poses + 8 * i), options) <= 1.0f;
+		}
+	}
+
+	if (!fits) {
+		// the previous sample ends the span and anchors the next one
+		keyTime = times[buffered - 1];
+		const pose previous = load(poses + 8 * (buffered - 1));
+		write(previous, key);
+		anchorTime = keyTime;
+		store(anchor, previous);
+
+		times[0] = time;
+		store(poses, p);
+		buffered = 1;
+		return true;
+	}
+
+	times[buffered] = time;
+	store(poses + 8 * buffered, p);
+	buffered++;
+	if (buffered < window) {
+		return false;
+	}
+
+	// out of room, the newest sample becomes a key
+	keyTime = time;
+	write(p, key);
+	anchorTime = time;
+	store(anchor, p);
+	buffered = 0;
+	return true;
+}
+
+bool keyStream::flush(float& keyTime, const dualquat_view& key) {
+	// the track ends even when its last sample was already a key
+	anchored = false;
+	if (buffered == 0) {
+		return false;
+	}
+
+	keyTime = times[buffered - 1];
+	write(load(poses + 8 * (buffered - 1)), key);
+	buffered = 0;
+	return true;
+}
+
+void keyStream::reset() {
+	buffered = 0;
+	anchored = false;
+}
\ No newline at end of file
@@ -1,6 +1,24 @@
 #include <iostream>
+#include <iomanip>
 #include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
 #include <functional>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #include "..\include\gmath.hpp"
 
@@ -9,6 +27,80 @@ using namespace gmath;
 const float PI = 3.1415927f;
 const int numTrials = 50000;
 
+// builds the matrix of the rigid transform given by unit rotation q followed by translation t
+mat quatAndVecToMat(const quat& q, const vec4& t) {
+	const __m128 colvec = _mm_load_ps(q.data);
+
+	const __m128 iiii = _mm_replicate_y_ps(colvec);
+	const __m128 jjjj = _mm_replicate_z_ps(colvec);
+	const __m128 kkkk = _mm_replicate_w_ps(colvec);
+
+	const __m128 col = _mm_load_ps(q.data);
+
+	// technically only need to do 9 mul but doing 12
+	// contains qiqr, qi^2, qiqj, qiqk
+	const vec4 mul1(_mm_mul_ps(iiii, col));
+	// contains qjqr, _ , qj^2, qjqk
+	const vec4 mul2(_mm_mul_ps(jjjj, col));
+	// contains qkqr, _ , _ , qk^2
+	const vec4 mul3(_mm_mul_ps(kkkk, col));
+
+	return mat(
+		vec4(1.0f - 2.0f * (mul2[2] + mul3[3]), 2.0f * (mul1[2] + mul3[0]), 2.0f * (mul1[3] - mul2[0])),
+		vec4(2.0f * (mul1[2] - mul3[0]), 1.0f - 2.0f * (mul1[1] + mul3[3]), 2.0f * (mul2[3] + mul1[0])),
+		vec4(2.0f * (mul1[3] + mul2[0]), 2.0f * (mul2[3] - mul1[0]), 1.0f - 2.0f * (mul1[1] + mul2[2])),
+		vec4(t[0], t[1], t[2], 1.0f)
+	);
+}
+
+// builds the matrix of the rigid transform given by unit dual quaternion d
+mat dualquatToMat(const dualquat& d) {
+	quat t = 2.0f * (d[1] * d[0].conjugate());
+
+	__m128 wxyz = _mm_load_ps(d[0].data);
+
+	__m128 wwww = _mm_replicate_x_ps(wxyz);
+	__m128 xxxx = _mm_replicate_y_ps(wxyz);
+	__m128 yyyy = _mm_replicate_z_ps(wxyz);
+	__m128 zzzz = _mm_replicate_w_ps(wxyz);
+
+	// contains ww, wx, wy, wz
+	float prod1[4];
+	_mm_store_ps(&prod1[0], _mm_mul_ps(wwww, wxyz));
+	
+	// contains xw, xx, xy, xz
+	float prod2[4];
+	_mm_store_ps(&prod2[0], _mm_mul_ps(xxxx, wxyz));
+
+	// contains yw, yx, yy, yz
+	float prod3[4];
+	_mm_store_ps(&prod3[0], _mm_mul_ps(yyyy, wxyz));
+
+
+	// contains zw, zx, zy, zz
+	float prod4[4];
+	_mm_store_ps(&prod4[0], _mm_mul_ps(zzzz, wxyz));
+
+	return mat(
+		vec4(
+			prod1[0] + prod2[1] - prod3[2] - prod4[3],
+			2.0f * (prod2[2] + prod1[3]),
+			2.0f * (prod2[3] - prod1[2])
+		),
+		vec4(
+			2.0f * (prod2[2] - prod1[3]),
+			prod1[0] - prod2[1] + prod3[2] - prod4[3],
+			2.0f * (prod3[3] + prod1[1])
+		),
+		vec4(
+			2.0f * (prod2[3] + prod1[2]),
+			2.0f * (prod3[3] - prod1[1]),
+			prod1[0] - prod2[1] - prod3[2] + prod4[3]
+		),
+		vec4(t[1], t[2], t[3], 1.0f)
+	);
+}
+
 // For this test:
 // concatenate transformations of this order:
 // translate 3, 4, 5
@@ -104,29 +196,7 @@ void testConcatTransformQuatAndVec() {
 	// update t
 	t = q4.transform(t);
 
-	// construct matrix
-	const __m128 colvec = _mm_load_ps(q.data);
-
-	const __m128 iiii = _mm_replicate_y_ps(colvec);
-	const __m128 jjjj = _mm_replicate_z_ps(colvec);
-	const __m128 kkkk = _mm_replicate_w_ps(colvec);
-
-	const __m128 col = _mm_load_ps(q.data);
-
-	// technically only need to do 9 mul but doing 12
-	// contains qiqr, qi^2, qiqj, qiqk
-	const vec4 mul1(_mm_mul_ps(iiii, col));
-	// contains qjqr, _ , qj^2, qjqk
-	const vec4 mul2(_mm_mul_ps(jjjj, col));
-	// contains qkqr, _ , _ , qk^2
-	const vec4 mul3(_mm_mul_ps(kkkk, col));
-
-	const mat result(
-		vec4(1.0f - 2.0f * (mul2[2] + mul3[3]), 2.0f * (mul1[2] + mul3[0]), 2.0f * (mul1[3] - mul2[0])),
-		vec4(2.0f * (mul1[2] - mul3[0]), 1.0f - 2.0f * (mul1[1] + mul3[3]), 2.0f * (mul2[3] + mul1[0])),
-		vec4(2.0f * (mul1[3] + mul2[0]), 2.0f * (mul2[3] - mul1[0]), 1.0f - 2.0f * (mul1[1] + mul2[2])),
-		vec4(t[0], t[1], t[2], 1.0f)
-	);
+	const mat result = quatAndVecToMat(q, t);
 
 	//std::cout << result.toString() << std::endl;
 }
@@ -176,55 +246,263 @@ void testConcatTransformDualQuat() {
 	const float e = SIN5 / sqrtf(3.0f);
 	d = dualquat(quat(COS5, -e, -e, e)) * d;
 
-	// construct matrix
-	quat t = 2.0f * (d[1] * d[0].conjugate());
+	const mat result = dualquatToMat(d);
 
-	__m128 wxyz = _mm_load_ps(d[0].data);
+	//std::cout << result.toString() << std::endl;
+}
 
-	__m128 wwww = _mm_replicate_x_ps(wxyz);
-	__m128 xxxx = _mm_replicate_y_ps(wxyz);
-	__m128 yyyy = _mm_replicate_z_ps(wxyz);
-	__m128 zzzz = _mm_replicate_w_ps(wxyz);
+// the eight step chain with tagged transforms, grouping the three consecutive axis
+// rotations so they compose as quaternions only
+mat rigidChain() {
+	const float radians1 = 30.0f * PI / 180.0f;
+	const float radians2 = 20.0f * PI / 180.0f;
+	const float radians3 = 25.0f * PI / 180.0f;
+	const rotation r1(unit_quat::fromAxisAngle(vec4(0.0f, 1.0f, 0.0f), radians1));
+	const rotation r2(unit_quat::fromAxisAngle(vec4(0.0f, 0.0f, 1.0f), radians2));
+	const rotation r3(unit_quat::fromAxisAngle(vec4(1.0f, 0.0f, 0.0f), radians3));
+	rigid_motion d = (r3 * (r2 * r1)) * translation(vec4(3.0f, 4.0f, 5.0f));
 
-	// contains ww, wx, wy, wz
-	float prod1[4];
-	_mm_store_ps(&prod1[0], _mm_mul_ps(wwww, wxyz));
-	
-	// contains xw, xx, xy, xz
-	float prod2[4];
-	_mm_store_ps(&prod2[0], _mm_mul_ps(xxxx, wxyz));
+	d = translation(vec4(-7.0f, -9.0f, -3.0f)) * d;
 
-	// contains yw, yx, yy, yz
-	float prod3[4];
-	_mm_store_ps(&prod3[0], _mm_mul_ps(yyyy, wxyz));
+	const float radians4 = 99.0f * PI / 180.0f;
+	d = rotation(unit_quat::fromAxisAngle(vec4(1.0f, 1.0f, 0.0f), radians4)) * d;
 
+	d = translation(vec4(0.0f, 4.0f, -1.0f)) * d;
 
-	// contains zw, zx, zy, zz
-	float prod4[4];
-	_mm_store_ps(&prod4[0], _mm_mul_ps(zzzz, wxyz));
+	const float radians5 = 12.0f * PI / 180.0f;
+	d = rotation(unit_quat::fromAxisAngle(vec4(-1.0f, -1.0f, 1.0f), radians5)) * d;
 
-	const mat result(
-		vec4(
-			prod1[0] + prod2[1] - prod3[2] - prod4[3],
-			2.0f * (prod2[2] + prod1[3]),
-			2.0f * (prod2[3] - prod1[2])
-		),
-		vec4(
-			2.0f * (prod2[2] - prod1[3]),
-			prod1[0] - prod2[1] + prod3[2] - prod4[3],
-			2.0f * (prod3[3] + prod1[1])
-		),
-		vec4(
-			2.0f * (prod2[3] + prod1[2]),
-			2.0f * (prod3[3] - prod1[1]),
-			prod1[0] - prod2[1] - prod3[2] + prod4[3]
-		),
-		vec4(t[1], t[2], t[3], 1.0f)
-	);
+	return d.toMat();
+}
+
+// For this test:
+// same chain as testConcatTransformDualQuat composed with rigidChain
+// construct resulting matrix
+void testConcatTransformRigid() {
+	const mat result = rigidChain();
+
+	//std::cout << result.toString() << std::endl;
+}
+
+// the eight step chain recorded with the builder
+transformChain builderChain() {
+	return transformChain()
+		.translate(vec4(3.0f, 4.0f, 5.0f))
+		.rotateY(30.0f * PI / 180.0f)
+		.rotateZ(20.0f * PI / 180.0f)
+		.rotateX(25.0f * PI / 180.0f)
+		.translate(vec4(-7.0f, -9.0f, -3.0f))
+		.rotate(vec4(1.0f, 1.0f, 0.0f), 99.0f * PI / 180.0f)
+		.translate(vec4(0.0f, 4.0f, -1.0f))
+		.rotate(vec4(-1.0f, -1.0f, 1.0f), 12.0f * PI / 180.0f);
+}
+
+// For this test:
+// same chain recorded with transformChain and collapsed every time
+// construct resulting matrix
+void testConcatTransformBuilder() {
+	const mat result = builderChain().toMat();
+
+	//std::cout << result.toString() << std::endl;
+}
+
+// For this test:
+// same chain recorded with transformChain, collapsed once and then served from the cache
+// construct resulting matrix
+void testConcatTransformBuilderCached() {
+	const mat result = builderChain().cachedMat();
 
 	//std::cout << result.toString() << std::endl;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														hardware counters
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Optional Linux perf_event_open counters around a benchmarked region. The events are opened
+// as one group so they are scheduled onto the PMU together and their ratios (IPC) come from the
+// same instructions. An event the group can't take is opened on its own instead, so a missing
+// event (common in virtual machines) does not disable the rest. Counts are scaled by
+// enabled / running time when the kernel multiplexed them. Everywhere else, or when the kernel
+// refuses, the counters report as unavailable.
+class perfCounters {
+public:
+	enum event { cycles, instructions, branchMisses, l1dMisses, llcMisses, eventCount };
+
+	perfCounters() {
+		for (int i = 0; i < eventCount; i++) {
+			fds[i] = -1;
+			leaders[i] = false;
+			values[i] = 0;
+			counted[i] = false;
+		}
+	}
+
+	~perfCounters() {
+		close();
+	}
+
+	// returns false and fills reason if no event could be opened
+	bool open(std::string& reason) {
+#ifdef __linux__
+		const uint32_t types[eventCount] = {
+			PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE
+		};
+		const uint64_t configs[eventCount] = {
+			PERF_COUNT_HW_CPU_CYCLES,
+			PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_BRANCH_MISSES,
+			PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+			PERF_COUNT_HW_CACHE_MISSES
+		};
+
+		bool any = false;
+		int group = -1;
+		for (int i = 0; i < eventCount; i++) {
+			perf_event_attr attr;
+			memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = types[i];
+			attr.config = configs[i];
+			attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+
+			// members follow the leader's enable state, leaders start disabled
+			attr.disabled = group < 0 ? 1 : 0;
+			fds[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+			if (fds[i] < 0 && group >= 0) {
+				attr.disabled = 1;
+				fds[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+				leaders[i] = fds[i] >= 0;
+			}
+			else if (fds[i] >= 0 && group < 0) {
+				group = fds[i];
+				leaders[i] = true;
+			}
+
+			if (fds[i] < 0) {
+				reason = std::string("perf_event_open: ") + strerror(errno);
+			}
+			any = any || fds[i] >= 0;
+		}
+
+		return any;
+#else
+		reason = "hardware counters are only supported on Linux";
+		return false;
+#endif
+	}
+
+	void close() {
+#ifdef __linux__
+		// members before their leader
+		for (int i = eventCount - 1; i >= 0; i--) {
+			if (fds[i] >= 0) {
+				::close(fds[i]);
+				fds[i] = -1;
+				leaders[i] = false;
+			}
+		}
+#endif
+	}
+
+	void start() {
+#ifdef __linux__
+		for (int i = 0; i < eventCount; i++) {
+			if (leaders[i]) {
+				ioctl(fds[i], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+				ioctl(fds[i], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+			}
+		}
+#endif
+	}
+
+	void stop() {
+#ifdef __linux__
+		for (int i = 0; i < eventCount; i++) {
+			if (leaders[i]) {
+				ioctl(fds[i], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+			}
+		}
+
+		for (int i = 0; i < eventCount; i++) {
+			values[i] = 0;
+			counted[i] = false;
+			// value, time enabled, time running
+			uint64_t sample[3];
+			if (fds[i] >= 0 && read(fds[i], sample, sizeof(sample)) == sizeof(sample) && sample[2] > 0) {
+				values[i] = sample[2] < sample[1]
+					? (uint64_t)((double)sample[0] * (double)sample[1] / (double)sample[2])
+					: sample[0];
+				counted[i] = true;
+			}
+		}
+#endif
+	}
+
+	// opened and actually on the PMU for part of the last start / stop
+	bool available(const event& e) const {
+		return fds[e] >= 0 && counted[e];
+	}
+
+	// counts from the last start / stop divided by ops, "n/a" for events that could not be opened or never ran
+	std::string report(const double& ops) const {
+		const char* names[eventCount] = { "cycles", "instructions", "branch-misses", "L1D-misses", "LLC-misses" };
+		std::stringstream stream;
+		stream << std::fixed << std::setprecision(2);
+
+		for (int i = 0; i < eventCount; i++) {
+			stream << names[i] << "/op: ";
+			if (available((event)i)) {
+				stream << (double)values[i] / ops;
+			}
+			else {
+				stream << "n/a";
+			}
+			stream << (i + 1 < eventCount ? ", " : "");
+		}
+
+		stream << ", IPC: ";
+		if (available(cycles) && available(instructions) && values[cycles] > 0) {
+			stream << (double)values[instructions] / (double)values[cycles];
+		}
+		else {
+			stream << "n/a";
+		}
+
+		return stream.str();
+	}
+
+	// comma separated per op values for csv output, empty fields for unavailable events
+	std::string csv(const double& ops) const {
+		std::stringstream stream;
+
+		for (int i = 0; i < eventCount; i++) {
+			if (available((event)i)) {
+				stream << (double)values[i] / ops;
+			}
+			stream << ",";
+		}
+		if (available(cycles) && available(instructions) && values[cycles] > 0) {
+			stream << (double)values[instructions] / (double)values[cycles];
+		}
+
+		return stream.str();
+	}
+
+private:
+	int fds[eventCount];
+	// true for the group leader and for events opened on their own
+	bool leaders[eventCount];
+	uint64_t values[eventCount];
+	bool counted[eventCount];
+};
+
+// set by --counters, counters stays closed otherwise
+bool countersEnabled = false;
+perfCounters counters;
+
 void runTest(const std::function<void()>& f, int numTrials) {
 	std::chrono::time_point<std::chrono::system_clock> t1;
 	std::chrono::time_point<std::chrono::system_clock> t2;
@@ -241,15 +519,2876 @@ void runTest(const std::function<void()>& f, int numTrials) {
 	}
 
 	std::cout << "Finished running " << numTrials << " trials. Time ellapsed: " << totalTime << "s." << std::endl;
+
+	if (countersEnabled) {
+		// separate pass so the clock reads above are not counted
+		counters.start();
+		for (int i = 0; i < numTrials; i++) {
+			f();
+		}
+		counters.stop();
+
+		std::cout << "  " << counters.report(numTrials) << std::endl;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														precision benchmark
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// one step of a random transform chain
+struct chainStep {
+	// 0 translate, 1 rotate x, 2 rotate y, 3 rotate z, 4 rotate about axis
+	int kind;
+	float radians;
+	float v[3];
+};
+
+// double precision rigid transform used as the reference for every path
+struct refTransform {
+	double r[3][3] = { { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 } };
+	double t[3] = { 0.0, 0.0, 0.0 };
+};
+
+struct precisionOptions {
+	std::vector<int> lengths = { 8, 64, 512, 4096 };
+	int chains = 200;
+	int renorm = 0;
+	unsigned int seed = 1;
+	bool csv = false;
+};
+
+struct precisionResult {
+	double nsPerStep = 0.0;
+	double maxError = 0.0;
+	double meanError = 0.0;
+	size_t steps = 0;
+};
+
+std::vector<chainStep> makeChain(std::mt19937& rng, const int length) {
+	std::uniform_int_distribution<int> kind(0, 4);
+	std::uniform_real_distribution<float> angle(-PI, PI);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::vector<chainStep> chain(length);
+
+	for (chainStep& step : chain) {
+		step.kind = kind(rng);
+		step.radians = angle(rng);
+		if (step.kind == 0) {
+			step.v[0] = 10.0f * unit(rng);
+			step.v[1] = 10.0f * unit(rng);
+			step.v[2] = 10.0f * unit(rng);
+		}
+		else {
+			// random unit axis, only used by kind 4
+			float len = 0.0f;
+			do {
+				step.v[0] = unit(rng);
+				step.v[1] = unit(rng);
+				step.v[2] = unit(rng);
+				len = sqrtf(step.v[0] * step.v[0] + step.v[1] * step.v[1] + step.v[2] * step.v[2]);
+			} while (len < 1e-3f || len > 1.0f);
+			step.v[0] /= len;
+			step.v[1] /= len;
+			step.v[2] /= len;
+		}
+	}
+
+	return chain;
+}
+
+refTransform runReference(const std::vector<chainStep>& chain) {
+	refTransform result;
+
+	for (const chainStep& step : chain) {
+		if (step.kind == 0) {
+			result.t[0] += step.v[0];
+			result.t[1] += step.v[1];
+			result.t[2] += step.v[2];
+			continue;
+		}
+
+		double a[3] = { 0.0, 0.0, 0.0 };
+		if (step.kind == 4) {
+			a[0] = step.v[0];
+			a[1] = step.v[1];
+			a[2] = step.v[2];
+		}
+		else {
+			a[step.kind - 1] = 1.0;
+		}
+
+		// Rodrigues' rotation formula
+		const double c = cos((double)step.radians);
+		const double s = sin((double)step.radians);
+		const double k = 1.0 - c;
+		const double r[3][3] = {
+			{ c + a[0] * a[0] * k, a[0] * a[1] * k - a[2] * s, a[0] * a[2] * k + a[1] * s },
+			{ a[1] * a[0] * k + a[2] * s, c + a[1] * a[1] * k, a[1] * a[2] * k - a[0] * s },
+			{ a[2] * a[0] * k - a[1] * s, a[2] * a[1] * k + a[0] * s, c + a[2] * a[2] * k }
+		};
+
+		refTransform next;
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 3; j++) {
+				next.r[i][j] = r[i][0] * result.r[0][j] + r[i][1] * result.r[1][j] + r[i][2] * result.r[2][j];
+			}
+			next.t[i] = r[i][0] * result.t[0] + r[i][1] * result.t[1] + r[i][2] * result.t[2];
+		}
+		result = next;
+	}
+
+	return result;
+}
+
+// re-orthonormalizes the rotation columns of m with Gram-Schmidt
+mat orthonormalize(const mat& m) {
+	const vec4 c1 = vec4(m[0][0], m[0][1], m[0][2]).normalize();
+	const vec4 c2 = (vec4(m[1][0], m[1][1], m[1][2]) - c1.dot(m[1]) * c1).normalize();
+	const vec4 c3(
+		c1[1] * c2[2] - c1[2] * c2[1],
+		c1[2] * c2[0] - c1[0] * c2[2],
+		c1[0] * c2[1] - c1[1] * c2[0]
+	);
+
+	return mat(c1, c2, c3, vec4(m[3]));
+}
+
+mat runMatrixChain(const std::vector<chainStep>& chain, const int renorm) {
+	mat m;
+
+	for (size_t i = 0; i < chain.size(); i++) {
+		const chainStep& step = chain[i];
+		switch (step.kind) {
+		case 0: m = mat::translate(vec4(step.v[0], step.v[1], step.v[2])) * m; break;
+		case 1: m = mat::rotateX(step.radians) * m; break;
+		case 2: m = mat::rotateY(step.radians) * m; break;
+		case 3: m = mat::rotateZ(step.radians) * m; break;
+		default: m = mat::rotate(vec4(step.v[0], step.v[1], step.v[2]), step.radians) * m; break;
+		}
+
+		if (renorm > 0 && (i + 1) % renorm == 0) {
+			m = orthonormalize(m);
+		}
+	}
+
+	return m;
+}
+
+quat stepRotation(const chainStep& step) {
+	const float COS = cosf(step.radians / 2.0f);
+	const float SIN = sinf(step.radians / 2.0f);
+
+	switch (step.kind) {
+	case 1: return quat(COS, SIN, 0.0f, 0.0f);
+	case 2: return quat(COS, 0.0f, SIN, 0.0f);
+	case 3: return quat(COS, 0.0f, 0.0f, SIN);
+	default: return quat(COS, SIN * step.v[0], SIN * step.v[1], SIN * step.v[2]);
+	}
+}
+
+mat runQuatAndVecChain(const std::vector<chainStep>& chain, const int renorm) {
+	quat q(1.0f);
+	vec4 t;
+
+	for (size_t i = 0; i < chain.size(); i++) {
+		const chainStep& step = chain[i];
+		if (step.kind == 0) {
+			t = t + vec4(step.v[0], step.v[1], step.v[2]);
+		}
+		else {
+			const quat r = stepRotation(step);
+			q = r * q;
+			t = r.transform(t);
+		}
+
+		if (renorm > 0 && (i + 1) % renorm == 0) {
+			q = q.normalize();
+		}
+	}
+
+	return quatAndVecToMat(q, t);
+}
+
+mat runDualQuatChain(const std::vector<chainStep>& chain, const int renorm) {
+	dualquat d(quat(1.0f));
+
+	for (size_t i = 0; i < chain.size(); i++) {
+		const chainStep& step = chain[i];
+		if (step.kind == 0) {
+			d = dualquat(quat(1.0f), vec4(step.v[0], step.v[1], step.v[2])) * d;
+		}
+		else {
+			d = dualquat(stepRotation(step)) * d;
+		}
+
+		if (renorm > 0 && (i + 1) % renorm == 0) {
+			d = d.normalize();
+		}
+	}
+
+	return dualquatToMat(d);
+}
+
+// largest distance between the images of a fixed set of probe points under m and the reference
+double chainError(const mat& m, const refTransform& ref, double& sum, int& count) {
+	static const float probes[8][3] = {
+		{ 10.0f, 10.0f, 10.0f }, { -10.0f, 10.0f, 10.0f }, { 10.0f, -10.0f, 10.0f }, { 10.0f, 10.0f, -10.0f },
+		{ -10.0f, -10.0f, 10.0f }, { -10.0f, 10.0f, -10.0f }, { 10.0f, -10.0f, -10.0f }, { -10.0f, -10.0f, -10.0f }
+	};
+	double maxError = 0.0;
+
+	for (const float* p : probes) {
+		const vec4 image = m * vec4(p[0], p[1], p[2], 1.0f);
+		double e2 = 0.0;
+		for (int i = 0; i < 3; i++) {
+			const double expected = ref.r[i][0] * p[0] + ref.r[i][1] * p[1] + ref.r[i][2] * p[2] + ref.t[i];
+			const double diff = (double)image[i] - expected;
+			e2 += diff * diff;
+		}
+
+		const double e = sqrt(e2);
+		maxError = e > maxError ? e : maxError;
+		sum += e;
+		count++;
+	}
+
+	return maxError;
+}
+
+precisionResult measurePath(
+	const std::function<mat(const std::vector<chainStep>&, int)>& path,
+	const std::vector<std::vector<chainStep>>& chains,
+	const std::vector<refTransform>& refs,
+	const int renorm
+) {
+	precisionResult result;
+	std::vector<mat> outputs(chains.size());
+	size_t steps = 0;
+
+	if (countersEnabled) {
+		counters.start();
+	}
+	const std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < chains.size(); i++) {
+		outputs[i] = path(chains[i], renorm);
+		steps += chains[i].size();
+	}
+	const std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+	if (countersEnabled) {
+		counters.stop();
+	}
+	result.steps = steps;
+	result.nsPerStep = std::chrono::duration<double, std::nano>(t2 - t1).count() / (double)steps;
+
+	double sum = 0.0;
+	int count = 0;
+	for (size_t i = 0; i < chains.size(); i++) {
+		const double e = chainError(outputs[i], refs[i], sum, count);
+		result.maxError = e > result.maxError ? e : result.maxError;
+	}
+	result.meanError = sum / count;
+
+	return result;
+}
+
+void runPrecisionBenchmark(const precisionOptions& options) {
+	const char* names[3] = { "mat", "quat+vec", "dualquat" };
+	const std::function<mat(const std::vector<chainStep>&, int)> paths[3] = {
+		runMatrixChain, runQuatAndVecChain, runDualQuatChain
+	};
+
+	if (options.csv) {
+		std::cout << "path,length,chains,renorm,ns_per_step,max_error,mean_error"
+			<< (countersEnabled ? ",cycles_per_step,instructions_per_step,branch_misses_per_step,l1d_misses_per_step,llc_misses_per_step,ipc" : "")
+			<< std::endl;
+	}
+	else {
+		std::cout << "Random transform chains: " << options.chains << " per length, renormalize every "
+			<< options.renorm << " steps (0 = never), seed " << options.seed << std::endl;
+		std::cout << std::left << std::setw(10) << "path" << std::setw(10) << "length"
+			<< std::setw(14) << "ns/step" << std::setw(14) << "max error" << "mean error" << std::endl;
+	}
+
+	for (const int length : options.lengths) {
+		std::mt19937 rng(options.seed + length);
+		std::vector<std::vector<chainStep>> chains;
+		std::vector<refTransform> refs;
+		for (int i = 0; i < options.chains; i++) {
+			chains.push_back(makeChain(rng, length));
+			refs.push_back(runReference(chains.back()));
+		}
+
+		for (int p = 0; p < 3; p++) {
+			const precisionResult r = measurePath(paths[p], chains, refs, options.renorm);
+			if (options.csv) {
+				std::cout << names[p] << "," << length << "," << options.chains << "," << options.renorm << ","
+					<< r.nsPerStep << "," << r.maxError << "," << r.meanError
+					<< (countersEnabled ? "," + counters.csv((double)r.steps) : "") << std::endl;
+			}
+			else {
+				std::cout << std::left << std::setw(10) << names[p] << std::setw(10) << length
+					<< std::setw(14) << r.nsPerStep << std::setw(14) << r.maxError << r.meanError << std::endl;
+				if (countersEnabled) {
+					std::cout << "  " << counters.report((double)r.steps) << std::endl;
+				}
+			}
+		}
+	}
 }
 
-int main() {
+// parses a comma separated list of chain lengths
+std::vector<int> parseLengths(const std::string& list) {
+	std::vector<int> lengths;
+	std::stringstream stream(list);
+	std::string item;
+
+	while (std::getline(stream, item, ',')) {
+		const int length = std::atoi(item.c_str());
+		if (length > 0) {
+			lengths.push_back(length);
+		}
+	}
+
+	return lengths;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														trig accuracy
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// distance between f and the correctly rounded value of ref in units in the last place of ref
+double ulpError(const float f, const double ref) {
+	const float rounded = (float)ref;
+	const float ulp = nextafterf(fabsf(rounded), INFINITY) - fabsf(rounded);
+	return fabs((double)f - ref) / (double)ulp;
+}
+
+// checks trig::sincos against libm and the batched constructors against their scalar equivalents,
+// returns false if any error bound is exceeded
+bool testTrigAccuracy() {
+	const int samples = 1 << 20;
+	const float range = 64.0f * PI;
+	std::vector<float> x(samples);
+	std::vector<float> s(samples);
+	std::vector<float> c(samples);
+	bool passed = true;
+
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> dist(-range, range);
+	for (int i = 0; i < samples; i++) {
+		// half evenly spaced, half random
+		x[i] = i % 2 == 0 ? -range + 2.0f * range * (float)i / (float)samples : dist(rng);
+	}
+
+	const trigAccuracy tiers[2] = { trigAccuracy::precise, trigAccuracy::fast };
+	const char* tierNames[2] = { "precise", "fast" };
+	for (int t = 0; t < 2; t++) {
+		trig::sincos(x.data(), s.data(), c.data(), samples, tiers[t]);
+
+		double maxAbs = 0.0;
+		double maxUlp = 0.0;
+		for (int i = 0; i < samples; i++) {
+			const double refS = sin((double)x[i]);
+			const double refC = cos((double)x[i]);
+			maxAbs = std::max(maxAbs, std::max(fabs(s[i] - refS), fabs(c[i] - refC)));
+			// ulp error is only meaningful away from the zeros, where the reduction error dominates
+			if (fabs(refS) > 1e-3) {
+				maxUlp = std::max(maxUlp, ulpError(s[i], refS));
+			}
+			if (fabs(refC) > 1e-3) {
+				maxUlp = std::max(maxUlp, ulpError(c[i], refC));
+			}
+		}
+
+		const bool ok = tiers[t] == trigAccuracy::precise ? maxUlp <= 2.0 && maxAbs <= 2e-7 : maxAbs <= 1e-4;
+		passed = passed && ok;
+		std::cout << "sincos " << tierNames[t] << ": max abs error " << maxAbs << ", max ulp error " << maxUlp
+			<< (ok ? " PASS" : " FAIL") << std::endl;
+	}
+
+	// asin and acos over [-1, 1], four lanes at a time
+	double asinUlp = 0.0;
+	double acosUlp = 0.0;
+	for (int i = 0; i < samples; i += 4) {
+		float in[4];
+		float outS[4];
+		float outC[4];
+		for (int l = 0; l < 4; l++) {
+			in[l] = -1.0f + 2.0f * (float)(i + l) / (float)(samples - 1);
+		}
+		_mm_storeu_ps(outS, trig::asin(_mm_loadu_ps(in)));
+		_mm_storeu_ps(outC, trig::acos(_mm_loadu_ps(in)));
+		for (int l = 0; l < 4; l++) {
+			if (fabs(in[l]) > 1e-6f) {
+				asinUlp = std::max(asinUlp, ulpError(outS[l], asin((double)in[l])));
+			}
+			acosUlp = std::max(acosUlp, ulpError(outC[l], acos((double)in[l])));
+		}
+	}
+	const bool inverseOk = asinUlp <= 3.0 && acosUlp <= 3.0;
+	passed = passed && inverseOk;
+	std::cout << "asin max ulp error " << asinUlp << ", acos max ulp error " << acosUlp << (inverseOk ? " PASS" : " FAIL") << std::endl;
+
+	// batched constructors against the scalar constructions used by the timing tests
+	const int count = 1003;
+	std::vector<vec4> axes(count);
+	std::vector<vec4> eulers(count);
+	std::vector<vec4> translations(count);
+	std::vector<float> radians(count);
+	std::vector<quat> axisAngle(count);
+	std::vector<quat> euler(count);
+	std::vector<dualquat> rigid(count);
+	for (int i = 0; i < count; i++) {
+		axes[i] = vec4(dist(rng), dist(rng), dist(rng)).normalize();
+		eulers[i] = vec4(dist(rng) / 64.0f, dist(rng) / 64.0f, dist(rng) / 64.0f);
+		translations[i] = vec4(dist(rng), dist(rng), dist(rng));
+		radians[i] = dist(rng) / 64.0f;
+	}
+
+	for (int t = 0; t < 2; t++) {
+		quat::fromAxisAngle(axes.data(), radians.data(), axisAngle.data(), count, tiers[t]);
+		quat::fromEuler(eulers.data(), euler.data(), count, tiers[t]);
+		dualquat::fromAxisAngle(axes.data(), radians.data(), translations.data(), rigid.data(), count, tiers[t]);
+
+		double maxError = 0.0;
+		for (int i = 0; i < count; i++) {
+			const float COS = cosf(radians[i] / 2.0f);
+			const float SIN = sinf(radians[i] / 2.0f);
+			const quat q(COS, SIN * axes[i][0], SIN * axes[i][1], SIN * axes[i][2]);
+			const quat qx(cosf(eulers[i][0] / 2.0f), sinf(eulers[i][0] / 2.0f), 0.0f, 0.0f);
+			const quat qy(cosf(eulers[i][1] / 2.0f), 0.0f, sinf(eulers[i][1] / 2.0f), 0.0f);
+			const quat qz(cosf(eulers[i][2] / 2.0f), 0.0f, 0.0f, sinf(eulers[i][2] / 2.0f));
+			const quat e = qz * (qy * qx);
+			const dualquat d(q, translations[i]);
+
+			for (uint32_t k = 0; k < 4; k++) {
+				maxError = std::max(maxError, (double)fabsf(axisAngle[i][k] - q[k]));
+				maxError = std::max(maxError, (double)fabsf(euler[i][k] - e[k]));
+				maxError = std::max(maxError, (double)fabsf(rigid[i][0][k] - d[0][k]));
+				// dual part scales with the translation
+				maxError = std::max(maxError, (double)fabsf(rigid[i][1][k] - d[1][k]) / range);
+			}
+		}
+
+		const bool ok = maxError <= (tiers[t] == trigAccuracy::precise ? 1e-6 : 1e-4);
+		passed = passed && ok;
+		std::cout << "batched constructors " << tierNames[t] << ": max error " << maxError
+			<< (ok ? " PASS" : " FAIL") << std::endl;
+	}
+
+	// throughput of the batched axis-angle constructor against scalar cosf / sinf
+	const int rounds = 200;
+	std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+	for (int r = 0; r < rounds; r++) {
+		for (int i = 0; i < count; i++) {
+			const float COS = cosf(radians[i] / 2.0f);
+			const float SIN = sinf(radians[i] / 2.0f);
+			axisAngle[i] = quat(COS, SIN * axes[i][0], SIN * axes[i][1], SIN * axes[i][2]);
+		}
+	}
+	std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+	std::cout << "scalar axis-angle quats: "
+		<< std::chrono::duration<double, std::nano>(t2 - t1).count() / ((double)rounds * count) << " ns each" << std::endl;
+
+	for (int t = 0; t < 2; t++) {
+		t1 = std::chrono::steady_clock::now();
+		for (int r = 0; r < rounds; r++) {
+			quat::fromAxisAngle(axes.data(), radians.data(), axisAngle.data(), count, tiers[t]);
+		}
+		t2 = std::chrono::steady_clock::now();
+		std::cout << "batched axis-angle quats (" << tierNames[t] << "): "
+			<< std::chrono::duration<double, std::nano>(t2 - t1).count() / ((double)rounds * count) << " ns each" << std::endl;
+	}
+
+	return passed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														palette
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// component storage behind a dualquat_soa
+struct dualquatBuffer {
+	std::vector<float> components[8];
+
+	dualquatBuffer(const size_t& count) {
+		for (std::vector<float>& c : components) {
+			c.resize(count);
+		}
+	}
+
+	dualquat_soa soa() {
+		dualquat_soa result;
+		for (int c = 0; c < 8; c++) {
+			result.data[c] = components[c].data();
+		}
+		result.count = components[0].size();
+		return result;
+	}
+
+	dualquat get(const size_t& i) const {
+		return dualquat(
+			quat(components[0][i], components[1][i], components[2][i], components[3][i]),
+			quat(components[4][i], components[5][i], components[6][i], components[7][i])
+		);
+	}
+
+	void set(const size_t& i, const dualquat& d) {
+		for (uint32_t c = 0; c < 8; c++) {
+			components[c][i] = d[c / 4][c % 4];
+		}
+	}
+};
+
+// random unit rigid transform
+dualquat randomPose(std::mt19937& rng) {
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	const quat r = quat(unit(rng), unit(rng), unit(rng), unit(rng)).normalize();
+	return dualquat(r, vec4(10.0f * unit(rng), 10.0f * unit(rng), 10.0f * unit(rng)));
+}
+
+// checks the batch palette builders against the dualquat operators and times both
+bool testPalette() {
+	const size_t count = 4099;
+	std::mt19937 rng(11);
+	dualquatBuffer world(count);
+	dualquatBuffer bind(count);
+	dualquatBuffer composed(count);
+	dualquatBuffer relative(count);
+	std::vector<float> composedMatrices(12 * count);
+	std::vector<float> relativeMatrices(12 * count);
+	std::vector<dualquat> worldObjects(count);
+	std::vector<dualquat> bindObjects(count);
+	for (size_t i = 0; i < count; i++) {
+		worldObjects[i] = randomPose(rng);
+		bindObjects[i] = randomPose(rng);
+		world.set(i, worldObjects[i]);
+		bind.set(i, bindObjects[i]);
+	}
+
+	palette::compose(world.soa(), bind.soa(), composed.soa());
+	palette::relative(world.soa(), bind.soa(), relative.soa());
+	palette::compose(world.soa(), bind.soa(), composedMatrices.data());
+	palette::relative(world.soa(), bind.soa(), relativeMatrices.data());
+
+	double maxError = 0.0;
+	for (size_t i = 0; i < count; i++) {
+		const dualquat c = worldObjects[i] * bindObjects[i];
+		const dualquat r = worldObjects[i].inverse() * bindObjects[i];
+		const mat cm = dualquatToMat(c);
+		const mat rm = dualquatToMat(r);
+		const dualquat cb = composed.get(i);
+		const dualquat rb = relative.get(i);
+
+		for (uint32_t k = 0; k < 8; k++) {
+			maxError = std::max(maxError, (double)fabsf(cb[k / 4][k % 4] - c[k / 4][k % 4]));
+			maxError = std::max(maxError, (double)fabsf(rb[k / 4][k % 4] - r[k / 4][k % 4]));
+		}
+		for (uint32_t row = 0; row < 3; row++) {
+			for (uint32_t col = 0; col < 4; col++) {
+				maxError = std::max(maxError, (double)fabsf(composedMatrices[12 * i + 4 * row + col] - cm[col][row]));
+				maxError = std::max(maxError, (double)fabsf(relativeMatrices[12 * i + 4 * row + col] - rm[col][row]));
+			}
+		}
+	}
+
+	bool passed = maxError <= 1e-4;
+	std::cout << "palette against dualquat operators: max error " << maxError << (passed ? " PASS" : " FAIL") << std::endl;
+
+	// unit = false, every pose scaled by a factor between 0.5 and 3, matrices against the
+	// normalized operator results
+	std::uniform_real_distribution<float> scale(0.5f, 3.0f);
+	dualquatBuffer scaledWorld(count);
+	dualquatBuffer scaledBind(count);
+	std::vector<float> worldMatrices(12 * count);
+	for (size_t i = 0; i < count; i++) {
+		scaledWorld.set(i, scale(rng) * worldObjects[i]);
+		scaledBind.set(i, scale(rng) * bindObjects[i]);
+	}
+
+	palette::relative(scaledWorld.soa(), scaledBind.soa(), relative.soa(), false);
+	palette::compose(scaledWorld.soa(), scaledBind.soa(), composedMatrices.data(), false);
+	palette::relative(scaledWorld.soa(), scaledBind.soa(), relativeMatrices.data(), false);
+	palette::toMatrices(scaledWorld.soa(), worldMatrices.data(), false);
+
+	double scaledError = 0.0;
+	for (size_t i = 0; i < count; i++) {
+		const dualquat a = scaledWorld.get(i);
+		const dualquat b = scaledBind.get(i);
+		const dualquat r = a.inverse() * b;
+		const mat cm = dualquatToMat((a * b).normalize());
+		const mat rm = dualquatToMat(r.normalize());
+		const mat wm = dualquatToMat(a.normalize());
+		const dualquat rb = relative.get(i);
+
+		for (uint32_t k = 0; k < 8; k++) {
+			scaledError = std::max(scaledError, (double)fabsf(rb[k / 4][k % 4] - r[k / 4][k % 4]));
+		}
+		for (uint32_t row = 0; row < 3; row++) {
+			for (uint32_t col = 0; col < 4; col++) {
+				scaledError = std::max(scaledError, (double)fabsf(composedMatrices[12 * i + 4 * row + col] - cm[col][row]));
+				scaledError = std::max(scaledError, (double)fabsf(relativeMatrices[12 * i + 4 * row + col] - rm[col][row]));
+				scaledError = std::max(scaledError, (double)fabsf(worldMatrices[12 * i + 4 * row + col] - wm[col][row]));
+			}
+		}
+	}
+
+	const bool scaledOk = scaledError <= 1e-4;
+	passed = passed && scaledOk;
+	std::cout << "palette on non unit poses against normalized dualquat operators: max error " << scaledError << (scaledOk ? " PASS" : " FAIL") << std::endl;
+
+	const int rounds = 100;
+	std::vector<dualquat> objectResults(count);
+	std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++) {
+		for (size_t i = 0; i < count; i++) {
+			objectResults[i] = worldObjects[i].inverse() * bindObjects[i];
+		}
+	}
+	std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+	std::cout << "relative poses with dualquat operators: "
+		<< std::chrono::duration<double, std::nano>(t2 - t1).count() / ((double)rounds * count) << " ns each" << std::endl;
+
+	t1 = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++) {
+		palette::relative(world.soa(), bind.soa(), relative.soa());
+	}
+	t2 = std::chrono::steady_clock::now();
+	std::cout << "relative poses with palette::relative: "
+		<< std::chrono::duration<double, std::nano>(t2 - t1).count() / ((double)rounds * count) << " ns each" << std::endl;
+
+	t1 = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++) {
+		palette::compose(world.soa(), bind.soa(), composedMatrices.data());
+	}
+	t2 = std::chrono::steady_clock::now();
+	std::cout << "skinning matrices with palette::compose: "
+		<< std::chrono::duration<double, std::nano>(t2 - t1).count() / ((double)rounds * count) << " ns each" << std::endl;
+
+	return passed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														scan
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// small random rigid motion, like one odometry step
+dualquat randomDelta(std::mt19937& rng) {
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	const float radians = 0.01f * unit(rng);
+	const vec4 axis = vec4(unit(rng), unit(rng), unit(rng) + 2.0f).normalize();
+	const float SIN = sinf(radians / 2.0f);
+	const quat r(cosf(radians / 2.0f), SIN * axis[0], SIN * axis[1], SIN * axis[2]);
+	return dualquat(r, vec4(0.01f * unit(rng), 0.01f * unit(rng), 0.1f));
+}
+
+// checks the parallel scans against a serial loop over dualquat::operator* and times both
+bool testScan() {
+	const size_t count = 1 << 21;
+	std::mt19937 rng(5);
+	dualquatBuffer deltas(count);
+	dualquatBuffer poses(count);
+	for (size_t i = 0; i < count; i++) {
+		deltas.set(i, randomDelta(rng));
+	}
+
+	std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+	dualquat pose = deltas.get(0);
+	for (size_t i = 1; i < count; i++) {
+		pose = deltas.get(i) * pose;
+	}
+	std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+	std::cout << "serial dualquat::operator* scan of " << count << " deltas: "
+		<< std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms" << std::endl;
+
+	// double precision reference, (a, b) * (c, d) = (ac, ad + bc)
+	std::vector<double> serial(8 * count);
+	double p[8] = { 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+	for (size_t i = 0; i < count; i++) {
+		double d[8];
+		for (int c = 0; c < 8; c++) {
+			d[c] = deltas.components[c][i];
+		}
+
+		const auto multiply = [](const double* a, const double* b, double* r) {
+			r[0] = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+			r[1] = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+			r[2] = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+			r[3] = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+		};
+		double ac[4], ad[4], bc[4];
+		multiply(d, p, ac);
+		multiply(d, p + 4, ad);
+		multiply(d + 4, p, bc);
+		for (int c = 0; c < 4; c++) {
+			p[c] = ac[c];
+			p[c + 4] = ad[c] + bc[c];
+		}
+		for (int c = 0; c < 8; c++) {
+			serial[8 * i + c] = p[c];
+		}
+	}
+
+	// float serial composition error for comparison
+	double serialError = 0.0;
+	for (uint32_t c = 0; c < 8; c++) {
+		serialError = std::max(serialError, fabs(pose[c / 4][c % 4] - serial[8 * (count - 1) + c]));
+	}
+	std::cout << "serial float error at the last pose: " << serialError << std::endl;
+
+	bool passed = true;
+	const uint32_t threadCounts[4] = { 1, 2, 4, 0 };
+	for (const uint32_t threads : threadCounts) {
+		scanOptions options;
+		options.threads = threads;
+		options.renormalizeEvery = 64;
+
+		t1 = std::chrono::steady_clock::now();
+		scan::inclusive(deltas.soa(), poses.soa(), options);
+		t2 = std::chrono::steady_clock::now();
+
+		// the dual part grows with the distance travelled, so its error is relative to its size
+		double maxError = 0.0;
+		for (size_t i = 0; i < count; i++) {
+			double dualSize = 1.0;
+			for (uint32_t c = 4; c < 8; c++) {
+				dualSize = std::max(dualSize, fabs(serial[8 * i + c]));
+			}
+			for (uint32_t c = 0; c < 8; c++) {
+				maxError = std::max(maxError, fabs(poses.components[c][i] - serial[8 * i + c]) / (c < 4 ? 1.0 : dualSize));
+			}
+		}
+
+		const bool ok = maxError <= 1e-3;
+		passed = passed && ok;
+		std::cout << "scan::inclusive with " << (threads == 0 ? std::thread::hardware_concurrency() : threads) << " thread(s): "
+			<< std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms, max error " << maxError
+			<< (ok ? " PASS" : " FAIL") << std::endl;
+	}
+
+	// exclusive scan of a short sequence is the inclusive scan moved up one entry
+	const size_t shortCount = 37;
+	dualquatBuffer shortDeltas(shortCount);
+	dualquatBuffer inclusivePoses(shortCount);
+	dualquatBuffer exclusivePoses(shortCount);
+	for (size_t i = 0; i < shortCount; i++) {
+		shortDeltas.set(i, deltas.get(i));
+	}
+	scanOptions options;
+	options.minEntriesPerThread = 4;
+	scan::inclusive(shortDeltas.soa(), inclusivePoses.soa(), options);
+	scan::exclusive(shortDeltas.soa(), exclusivePoses.soa(), options);
+
+	double maxError = fabs(exclusivePoses.components[0][0] - 1.0f);
+	for (size_t i = 1; i < shortCount; i++) {
+		for (uint32_t c = 0; c < 8; c++) {
+			maxError = std::max(maxError, (double)fabsf(exclusivePoses.components[c][i] - inclusivePoses.components[c][i - 1]));
+			maxError = std::max(maxError, fabs(inclusivePoses.components[c][i] - serial[8 * i + c]));
+		}
+	}
+
+	const bool ok = maxError <= 1e-4;
+	passed = passed && ok;
+	std::cout << "scan::exclusive on " << shortCount << " deltas: max error " << maxError << (ok ? " PASS" : " FAIL") << std::endl;
+
+	return passed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														pose buffer
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// one writer publishes frames where every float of every pose equals the frame's generation,
+// reader threads check that each snapshot holds a single generation and that generations
+// never go backwards, returns false on any torn or stale read
+bool testPoseBufferStress() {
+	const size_t poseCount = 2048;
+	const uint64_t frames = 20000;
+	const int readerCount = 3;
+	poseBuffer buffer(poseCount, 2 + readerCount);
+
+	std::atomic<bool> done(false);
+	std::atomic<uint64_t> torn(0);
+	std::atomic<uint64_t> backwards(0);
+	std::atomic<uint64_t> snapshots(0);
+
+	auto reader = [&](const int id) {
+		std::mt19937 rng(id);
+		uint64_t last = 0;
+		while (!done.load()) {
+			const poseBuffer::snapshot s = buffer.read();
+			const uint64_t generation = s.generation();
+			const float expected = (float)(generation & 0xFFFFF);
+			if (generation < last) {
+				backwards++;
+			}
+			last = generation;
+
+			// a first pass, then a delay while pinned, then a second pass so that a writer
+			// overwriting a pinned slot would be caught
+			const dualquat_span poses = s.poses();
+			bool ok = true;
+			for (int pass = 0; pass < 2; pass++) {
+				for (size_t i = 0; i < poses.size(); i++) {
+					const dualquat_view pose = poses[i];
+					for (uint32_t c = 0; c < 8; c++) {
+						// before the first publish every pose is the identity
+						const float value = generation == 0 ? (c == 0 ? 1.0f : 0.0f) : expected;
+						ok = ok && pose[c / 4][c % 4] == value;
+					}
+				}
+				if (pass == 0 && rng() % 4 == 0) {
+					std::this_thread::yield();
+				}
+			}
+
+			torn += ok ? 0 : 1;
+			snapshots++;
+		}
+	};
+
+	std::vector<std::thread> readers;
+	for (int i = 0; i < readerCount; i++) {
+		readers.emplace_back(reader, i);
+	}
+
+	const std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+	for (uint64_t frame = 1; frame <= frames; frame++) {
+		const dualquat_span poses = buffer.beginWrite();
+		const float value = (float)(frame & 0xFFFFF);
+		for (size_t i = 0; i < poses.size(); i++) {
+			float* pose = poses[i].data[0].data;
+			for (int c = 0; c < 8; c++) {
+				pose[c] = value;
+			}
+		}
+		buffer.publish();
+	}
+	const std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+	done.store(true);
+	for (std::thread& t : readers) {
+		t.join();
+	}
+
+	const bool passed = torn.load() == 0 && backwards.load() == 0 && buffer.read().generation() == frames;
+	std::cout << "pose buffer: " << frames << " frames of " << poseCount << " poses, " << readerCount << " readers, "
+		<< snapshots.load() << " snapshots, " << torn.load() << " torn, " << backwards.load() << " out of order, "
+		<< std::chrono::duration<double, std::milli>(t2 - t1).count() / frames << " ms per frame written"
+		<< (passed ? " PASS" : " FAIL") << std::endl;
+
+	return passed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														qtangent
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// interleaved vertex layout the qtangent spans read and write through
+struct tangentVertex {
+	float position[4];
+	float tangent[4];
+	float bitangent[4];
+	float normal[4];
+	float qtangent[4];
+};
+
+double vectorError(const float* a, const vec4& b) {
+	return std::max((double)fabsf(a[0] - b[0]), std::max((double)fabsf(a[1] - b[1]), (double)fabsf(a[2] - b[2])));
+}
+
+// checks qtangent encode / decode, snorm16 packing and palette skinning against rotated frames and times them
+bool testQTangent() {
+	const size_t count = 10003;
+	const uint32_t influences = 4;
+	const size_t joints = 64;
+	std::mt19937 rng(17);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_int_distribution<uint32_t> joint(0, joints - 1);
+
+	std::vector<tangentVertex> vertices(count);
+	std::vector<quat> frames(count);
+	std::vector<bool> mirrored(count);
+	for (size_t i = 0; i < count; i++) {
+		frames[i] = quat(unit(rng), unit(rng), unit(rng), unit(rng)).normalize();
+		// every eighth frame sits right at the real = 0 seam
+		if (i % 8 == 0) {
+			frames[i][0] = 0.0f;
+			frames[i] = frames[i].normalize();
+		}
+		mirrored[i] = i % 3 == 0;
+		const vec4 t = frames[i].transform(vec4(1.0f, 0.0f, 0.0f));
+		const vec4 b = frames[i].transform(vec4(0.0f, mirrored[i] ? -1.0f : 1.0f, 0.0f));
+		const vec4 n = frames[i].transform(vec4(0.0f, 0.0f, 1.0f));
+		for (uint32_t c = 0; c < 4; c++) {
+			vertices[i].tangent[c] = t[c];
+			vertices[i].bitangent[c] = b[c];
+			vertices[i].normal[c] = n[c];
+		}
+	}
+
+	const size_t stride = sizeof(tangentVertex);
+	const vec4_span tangents(vertices[0].tangent, count, stride);
+	const vec4_span bitangents(vertices[0].bitangent, count, stride);
+	const vec4_span normals(vertices[0].normal, count, stride);
+	const quat_span qtangents(vertices[0].qtangent, count, stride);
+
+	qtangent::encode(tangents, bitangents, normals, qtangents);
+
+	std::vector<int16_t> packed(4 * count);
+	std::vector<float> unpacked(4 * count);
+	const quat_span unpackedSpan(unpacked.data(), count, 4 * sizeof(float));
+	qtangent::pack(qtangents, packed.data());
+	qtangent::unpack(packed.data(), unpackedSpan);
+
+	std::vector<float> decoded(12 * count);
+	const vec4_span decodedT(decoded.data(), count, 12 * sizeof(float));
+	const vec4_span decodedB(decoded.data() + 4, count, 12 * sizeof(float));
+	const vec4_span decodedN(decoded.data() + 8, count, 12 * sizeof(float));
+
+	double encodeError = 0.0;
+	double packError = 0.0;
+	size_t signErrors = 0;
+	for (int pass = 0; pass < 2; pass++) {
+		qtangent::decode(pass == 0 ? qtangents : unpackedSpan, decodedT, decodedB, decodedN);
+		double& error = pass == 0 ? encodeError : packError;
+		for (size_t i = 0; i < count; i++) {
+			const float* d = decoded.data() + 12 * i;
+			error = std::max(error, vectorError(d, vec4(vertices[i].tangent[0], vertices[i].tangent[1], vertices[i].tangent[2])));
+			error = std::max(error, vectorError(d + 4, vec4(vertices[i].bitangent[0], vertices[i].bitangent[1], vertices[i].bitangent[2])));
+			error = std::max(error, vectorError(d + 8, vec4(vertices[i].normal[0], vertices[i].normal[1], vertices[i].normal[2])));
+			const float w = pass == 0 ? vertices[i].qtangent[0] : unpacked[4 * i];
+			if ((w < 0.0f) != mirrored[i]) {
+				signErrors++;
+			}
+		}
+	}
+
+	// skin against each frame rotated by the same blend done in double precision
+	dualquatBuffer palette(joints);
+	for (size_t j = 0; j < joints; j++) {
+		palette.set(j, randomPose(rng));
+	}
+	std::vector<uint32_t> vertexJoints(influences * count);
+	std::vector<float> weights(influences * count);
+	for (size_t i = 0; i < count; i++) {
+		float sum = 0.0f;
+		for (uint32_t k = 0; k < influences; k++) {
+			vertexJoints[influences * i + k] = joint(rng);
+			weights[influences * i + k] = 0.5f * unit(rng) + 0.5f;
+			sum += weights[influences * i + k];
+		}
+		for (uint32_t k = 0; k < influences; k++) {
+			weights[influences * i + k] /= sum;
+		}
+	}
+
+	std::vector<float> skinned(4 * count);
+	const quat_span skinnedSpan(skinned.data(), count, 4 * sizeof(float));
+	qtangent::skin(qtangents, vertexJoints.data(), weights.data(), influences, palette.soa(), skinnedSpan);
+	qtangent::decode(skinnedSpan, decodedT, decodedB, decodedN);
+
+	double skinError = 0.0;
+	for (size_t i = 0; i < count; i++) {
+		double blend[4] = { 0.0, 0.0, 0.0, 0.0 };
+		const dualquat first = palette.get(vertexJoints[influences * i]);
+		for (uint32_t k = 0; k < influences; k++) {
+			const dualquat d = palette.get(vertexJoints[influences * i + k]);
+			double dot = 0.0;
+			for (uint32_t c = 0; c < 4; c++) {
+				dot += (double)first[0][c] * d[0][c];
+			}
+			const double w = dot < 0.0 ? -weights[influences * i + k] : weights[influences * i + k];
+			for (uint32_t c = 0; c < 4; c++) {
+				blend[c] += w * d[0][c];
+			}
+		}
+		const double len = sqrt(blend[0] * blend[0] + blend[1] * blend[1] + blend[2] * blend[2] + blend[3] * blend[3]);
+		const quat r((float)(blend[0] / len), (float)(blend[1] / len), (float)(blend[2] / len), (float)(blend[3] / len));
+
+		const float* d = decoded.data() + 12 * i;
+		skinError = std::max(skinError, vectorError(d, r.transform(vec4(vertices[i].tangent[0], vertices[i].tangent[1], vertices[i].tangent[2]))));
+		skinError = std::max(skinError, vectorError(d + 4, r.transform(vec4(vertices[i].bitangent[0], vertices[i].bitangent[1], vertices[i].bitangent[2]))));
+		skinError = std::max(skinError, vectorError(d + 8, r.transform(vec4(vertices[i].normal[0], vertices[i].normal[1], vertices[i].normal[2]))));
+		if ((skinned[4 * i] < 0.0f) != mirrored[i]) {
+			signErrors++;
+		}
+	}
+
+	const bool encodePassed = encodeError <= 1e-4;
+	const bool packPassed = packError <= 2e-4;
+	const bool skinPassed = skinError <= 1e-4;
+	std::cout << "encode / decode: max error " << encodeError << (encodePassed ? " PASS" : " FAIL") << std::endl;
+	std::cout << "snorm16 pack / unpack / decode: max error " << packError << (packPassed ? " PASS" : " FAIL") << std::endl;
+	std::cout << "skin against blended rotation: max error " << skinError << (skinPassed ? " PASS" : " FAIL") << std::endl;
+	std::cout << "mirror sign mismatches: " << signErrors << (signErrors == 0 ? " PASS" : " FAIL") << std::endl;
+
+	const int rounds = 100;
+	std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++) {
+		qtangent::decode(qtangents, decodedT, decodedB, decodedN);
+	}
+	std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+	std::cout << "decode: " << std::chrono::duration<double, std::nano>(t2 - t1).count() / ((double)rounds * count) << " ns each" << std::endl;
+
+	t1 = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++) {
+		qtangent::skin(qtangents, vertexJoints.data(), weights.data(), influences, palette.soa(), skinnedSpan);
+	}
+	t2 = std::chrono::steady_clock::now();
+	std::cout << "skin with " << influences << " influences: "
+		<< std::chrono::duration<double, std::nano>(t2 - t1).count() / ((double)rounds * count) << " ns each" << std::endl;
+
+	return encodePassed && packPassed && skinPassed && signErrors == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														keyframes
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// smooth motion with holds, like a captured joint track sampled at a fixed rate
+dualquat recordedPose(const float& t, const float& phase) {
+	const float hold = sinf(0.4f * t + phase) > 0.6f ? 0.0f : 1.0f;
+	const float radians = 0.8f * sinf(0.9f * t + phase) * hold + 0.2f * t;
+	const vec4 axis = vec4(sinf(0.3f * t + phase), 1.0f, cosf(0.2f * t)).normalize();
+	const float SIN = sinf(radians / 2.0f);
+	const quat r(cosf(radians / 2.0f), SIN * axis[0], SIN * axis[1], SIN * axis[2]);
+	return dualquat(r, vec4(sinf(t + phase), 0.5f * cosf(0.7f * t) * hold, 0.1f * t));
+}
+
+// translation distance and rotation angle between two unit dual quaternions, in double precision
+void poseDistance(const dualquat& a, const dualquat& b, double& distance, double& angle) {
+	double d = 0.0;
+	double ta[3];
+	double tb[3];
+	for (uint32_t c = 0; c < 4; c++) {
+		d += (double)a[0][c] * b[0][c];
+	}
+	// angle from the chord to the nearer of b and -b, acos is too coarse near zero for float input
+	double chord = 0.0;
+	for (uint32_t c = 0; c < 4; c++) {
+		const double e = (double)a[0][c] - (d < 0.0 ? -1.0 : 1.0) * b[0][c];
+		chord += e * e;
+	}
+	for (uint32_t c = 0; c < 3; c++) {
+		// vector part of 2 dual * conjugate(real)
+		const uint32_t i = c + 1, j = (c + 1) % 3 + 1, k = (c + 2) % 3 + 1;
+		ta[c] = 2.0 * ((double)-a[1][0] * a[0][i] + (double)a[1][i] * a[0][0] - (double)a[1][j] * a[0][k] + (double)a[1][k] * a[0][j]);
+		tb[c] = 2.0 * ((double)-b[1][0] * b[0][i] + (double)b[1][i] * b[0][0] - (double)b[1][j] * b[0][k] + (double)b[1][k] * b[0][j]);
+	}
+	distance = sqrt((ta[0] - tb[0]) * (ta[0] - tb[0]) + (ta[1] - tb[1]) * (ta[1] - tb[1]) + (ta[2] - tb[2]) * (ta[2] - tb[2]));
+	angle = 4.0 * asin(std::min(1.0, 0.5 * sqrt(chord)));
+}
+
+// largest translation and rotation errors of the keys sampled back at every sample time
+void reconstructionError(
+	const std::vector<float>& times,
+	dualquatBuffer& samples,
+	std::vector<float>& keyTimes,
+	dualquatBuffer& keys,
+	const size_t& keyCount,
+	const keyInterpolation& interpolation,
+	double& distance,
+	double& angle
+) {
+	const size_t count = times.size();
+	dualquatBuffer rebuilt(count);
+	dualquat_soa keySoa = keys.soa();
+	keySoa.count = keyCount;
+	keyframes::sample(keyTimes.data(), keySoa, times.data(), rebuilt.soa(), interpolation);
+
+	distance = 0.0;
+	angle = 0.0;
+	for (size_t i = 0; i < count; i++) {
+		double d, a;
+		poseDistance(rebuilt.get(i), samples.get(i), d, a);
+		distance = std::max(distance, d);
+		angle = std::max(angle, a);
+	}
+}
+
+// checks that reduced tracks rebuild within tolerance for every mode and reports the compression and speed
+bool testKeyframes() {
+	const size_t trackCount = 64;
+	const size_t count = 2400;
+	const float rate = 120.0f;
+	keyReduceOptions options;
+	options.positionTolerance = 1e-3f;
+	options.angleTolerance = 2e-3f;
+
+	std::vector<float> times(count);
+	for (size_t i = 0; i < count; i++) {
+		times[i] = (float)i / rate;
+	}
+	std::vector<dualquatBuffer> samples(trackCount, dualquatBuffer(count));
+	std::vector<dualquatBuffer> keys(trackCount, dualquatBuffer(count));
+	std::vector<std::vector<float>> keyTimes(trackCount, std::vector<float>(count));
+	std::vector<keyTrack> tracks(trackCount);
+	for (size_t t = 0; t < trackCount; t++) {
+		for (size_t i = 0; i < count; i++) {
+			samples[t].set(i, recordedPose(times[i], 0.37f * t));
+		}
+		tracks[t].times = times.data();
+		tracks[t].samples = samples[t].soa();
+		tracks[t].keyTimes = keyTimes[t].data();
+		tracks[t].keys = keys[t].soa();
+	}
+
+	// float rounding of the rebuilt pose on top of the tolerance
+	const double slack = 2e-5;
+	bool passed = true;
+	const keyInterpolation modes[2] = { keyInterpolation::dlb, keyInterpolation::sclerp };
+	const char* modeNames[2] = { "dlb", "sclerp" };
+	for (int mode = 0; mode < 2; mode++) {
+		for (int fit = 0; fit < 2; fit++) {
+			options.interpolation = modes[mode];
+			options.refit = fit == 1;
+
+			const std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+			keyframes::reduce(tracks.data(), trackCount, options);
+			const std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+			size_t keyTotal = 0;
+			double distance = 0.0;
+			double angle = 0.0;
+			bool endsKept = true;
+			for (size_t t = 0; t < trackCount; t++) {
+				double d, a;
+				reconstructionError(times, samples[t], keyTimes[t], keys[t], tracks[t].keyCount, modes[mode], d, a);
+				distance = std::max(distance, d);
+				angle = std::max(angle, a);
+				keyTotal += tracks[t].keyCount;
+
+				// the first and last keys are the first and last samples, refit or not
+				const size_t last = tracks[t].keyCount - 1;
+				endsKept = endsKept && keyTimes[t][0] == times[0] && keyTimes[t][last] == times[count - 1];
+				for (int c = 0; c < 8; c++) {
+					endsKept = endsKept && keys[t].components[c][0] == samples[t].components[c][0]
+						&& keys[t].components[c][last] == samples[t].components[c][count - 1];
+				}
+			}
+
+			const bool ok = distance <= options.positionTolerance + slack && angle <= options.angleTolerance + slack && endsKept;
+			passed = passed && ok;
+			std::cout << "keyframes::reduce " << modeNames[mode] << (fit == 1 ? " with refit" : "") << ": "
+				<< (double)(trackCount * count) / keyTotal << "x fewer keys, max error " << distance << " / " << angle << " rad, "
+				<< std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms" << (endsKept ? "" : ", ends moved") << (ok ? " PASS" : " FAIL") << std::endl;
+		}
+	}
+
+	// streaming reducer on the same tracks, one sample at a time
+	options.refit = false;
+	for (int mode = 0; mode < 2; mode++) {
+		options.interpolation = modes[mode];
+		keyStream stream(options, 128);
+		size_t keyTotal = 0;
+		double distance = 0.0;
+		double angle = 0.0;
+		float key[8];
+		const std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+		for (size_t t = 0; t < trackCount; t++) {
+			size_t keyCount = 0;
+			float keyTime;
+			for (size_t i = 0; i < count; i++) {
+				float sample[8];
+				for (int c = 0; c < 8; c++) {
+					sample[c] = samples[t].components[c][i];
+				}
+				if (stream.push(times[i], dualquat_view(sample), keyTime, dualquat_view(key))) {
+					keyTimes[t][keyCount] = keyTime;
+					keys[t].set(keyCount++, dualquat(dualquat_view(key)));
+				}
+			}
+			if (stream.flush(keyTime, dualquat_view(key))) {
+				keyTimes[t][keyCount] = keyTime;
+				keys[t].set(keyCount++, dualquat(dualquat_view(key)));
+			}
+			stream.reset();
+			tracks[t].keyCount = keyCount;
+			keyTotal += keyCount;
+		}
+		const std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+		for (size_t t = 0; t < trackCount; t++) {
+			double d, a;
+			reconstructionError(times, samples[t], keyTimes[t], keys[t], tracks[t].keyCount, modes[mode], d, a);
+			distance = std::max(distance, d);
+			angle = std::max(angle, a);
+		}
+
+		const bool ok = distance <= options.positionTolerance + slack && angle <= options.angleTolerance + slack;
+		passed = passed && ok;
+		std::cout << "keyStream " << modeNames[mode] << ": " << (double)(trackCount * count) / keyTotal << "x fewer keys, max error "
+			<< distance << " / " << angle << " rad, " << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms"
+			<< (ok ? " PASS" : " FAIL") << std::endl;
+	}
+
+	// a flush right after the window filled has no key pending, it still has to end the track so
+	// the first sample of the next one is a key
+	{
+		const size_t window = 4;
+		keyStream stream(options, window);
+		float held[8] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.5f, 0.0f, 0.0f };
+		float key[8];
+		float keyTime = -1.0f;
+		size_t keyCount = 0;
+		for (size_t i = 0; i <= window; i++) {
+			keyCount += stream.push((float)i / rate, dualquat_view(held), keyTime, dualquat_view(key)) ? 1 : 0;
+		}
+		const bool windowKey = keyCount == 2 && keyTime == (float)window / rate;
+		const bool pending = stream.flush(keyTime, dualquat_view(key));
+
+		float next[8] = { 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+		keyTime = -1.0f;
+		const bool nextKey = stream.push(0.0f, dualquat_view(next), keyTime, dualquat_view(key)) && keyTime == 0.0f && key[1] == 1.0f;
+
+		const bool ok = windowKey && !pending && nextKey;
+		passed = passed && ok;
+		std::cout << "keyStream flush after a full window: next track starts with a key" << (ok ? " PASS" : " FAIL") << std::endl;
+	}
+
+	return passed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														ik
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// world position of every joint and of the end effector, with the quat and dualquat operators
+void chainPositions(const dualquat& root, const std::vector<quat>& local, const std::vector<vec4>& offsets, std::vector<quat>& world, std::vector<vec4>& positions) {
+	positions[0] = root.transform(vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	for (size_t j = 0; j < local.size(); j++) {
+		world[j] = (j == 0 ? root[0] : world[j - 1]) * local[j];
+		positions[j + 1] = positions[j] + world[j].transform(offsets[j]);
+	}
+}
+
+// cyclic coordinate descent on one chain with the operators, how it is done without the batch solver
+bool solveChainWithOperators(const dualquat& root, std::vector<quat>& local, const std::vector<vec4>& offsets, const vec4& target, const ikOptions& options) {
+	const size_t joints = local.size();
+	std::vector<quat> world(joints);
+	std::vector<vec4> positions(joints + 1);
+	for (uint32_t iteration = 0; iteration < options.iterations; iteration++) {
+		chainPositions(root, local, offsets, world, positions);
+		if ((positions[joints] - target).magnitude() <= options.tolerance) {
+			return true;
+		}
+
+		for (size_t j = joints; j-- > 0;) {
+			const vec4 e = (positions[joints] - positions[j]).normalize();
+			const vec4 t = (target - positions[j]).normalize();
+			const quat turn = quat(
+				1.0f + e.dot(t),
+				e[1] * t[2] - e[2] * t[1],
+				e[2] * t[0] - e[0] * t[2],
+				e[0] * t[1] - e[1] * t[0]
+			).normalize();
+			local[j] = ((j == 0 ? root[0] : world[j - 1]).conjugate() * turn * world[j]).normalize();
+			chainPositions(root, local, offsets, world, positions);
+		}
+	}
+
+	chainPositions(root, local, offsets, world, positions);
+	return (positions[joints] - target).magnitude() <= options.tolerance;
+}
+
+// checks both solvers against end effector positions from the operators and times them against
+// per chain cyclic coordinate descent written with the operators
+bool testIk() {
+	const size_t count = 4096;
+	const uint32_t joints = 3;
+	std::mt19937 rng(23);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	// reachable targets: the end effector of a random pose of each chain
+	std::vector<dualquat> roots(count);
+	std::vector<std::vector<vec4>> offsets(count, std::vector<vec4>(joints));
+	std::vector<vec4> targets(count);
+	dualquatBuffer rootBuffer(count);
+	std::vector<float> offsetBuffer(3 * joints * count);
+	std::vector<float> targetBuffer(3 * count);
+	for (size_t i = 0; i < count; i++) {
+		roots[i] = randomPose(rng);
+		rootBuffer.set(i, roots[i]);
+
+		std::vector<quat> pose(joints);
+		for (uint32_t j = 0; j < joints; j++) {
+			offsets[i][j] = vec4(0.1f * unit(rng), 0.7f + 0.3f * unit(rng), 0.1f * unit(rng));
+			pose[j] = quat(1.0f, 0.5f * unit(rng), 0.5f * unit(rng), 0.5f * unit(rng)).normalize();
+			for (uint32_t c = 0; c < 3; c++) {
+				offsetBuffer[(c * joints + j) * count + i] = offsets[i][j][c];
+			}
+		}
+
+		std::vector<quat> world(joints);
+		std::vector<vec4> positions(joints + 1);
+		chainPositions(roots[i], pose, offsets[i], world, positions);
+		targets[i] = positions[joints];
+		for (uint32_t c = 0; c < 3; c++) {
+			targetBuffer[c * count + i] = targets[i][c];
+		}
+	}
+
+	std::vector<float> rotationBuffer(4 * joints * count);
+	ikChains chains;
+	chains.count = count;
+	chains.joints = joints;
+	for (uint32_t c = 0; c < 4; c++) {
+		chains.rotations.data[c] = rotationBuffer.data() + c * joints * count;
+	}
+	chains.rotations.count = joints * count;
+	for (uint32_t c = 0; c < 3; c++) {
+		chains.offsets[c] = offsetBuffer.data() + c * joints * count;
+		chains.targets[c] = targetBuffer.data() + c * count;
+	}
+	chains.roots = rootBuffer.soa();
+
+	const auto reset = [&]() {
+		for (size_t k = 0; k < joints * count; k++) {
+			rotationBuffer[k] = 1.0f;
+		}
+		std::fill(rotationBuffer.begin() + joints * count, rotationBuffer.end(), 0.0f);
+	};
+
+	// end effector distance from the target and largest joint angle of chain i, from the operators
+	const auto check = [&](const size_t& i, double& miss, double& angle) {
+		std::vector<quat> local(joints);
+		for (uint32_t j = 0; j < joints; j++) {
+			const size_t k = j * count + i;
+			local[j] = quat(chains.rotations.data[0][k], chains.rotations.data[1][k], chains.rotations.data[2][k], chains.rotations.data[3][k]);
+			angle = std::max(angle, 2.0 * acos(std::min(1.0, (double)fabsf(local[j][0]) / local[j].norm())));
+		}
+		std::vector<quat> world(joints);
+		std::vector<vec4> positions(joints + 1);
+		chainPositions(roots[i], local, offsets[i], world, positions);
+		miss = (positions[joints] - targets[i]).magnitude();
+	};
+
+	ikOptions referenceOptions;
+	referenceOptions.iterations = 32;
+	size_t referenceConverged = 0;
+	const std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < count; i++) {
+		std::vector<quat> local(joints, quat(1.0f));
+		referenceConverged += solveChainWithOperators(roots[i], local, offsets[i], targets[i], referenceOptions) ? 1 : 0;
+	}
+	const std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+	std::cout << "ccd with quat operators: " << referenceConverged << " / " << count << " chains in tolerance, "
+		<< std::chrono::duration<double, std::nano>(t2 - t1).count() / count << " ns per chain" << std::endl;
+
+	bool passed = true;
+	const ikMethod methods[2] = { ikMethod::ccd, ikMethod::fabrik };
+	const char* methodNames[2] = { "ccd", "fabrik" };
+	// no limits, angle limits, and a hinge about an axis that is not unit length
+	const char* limitNames[3] = { "", " with angle limits", " with hinge limits" };
+	const vec4 hingeAxis(1.0f, 2.0f, 2.0f);
+	const vec4 unitHingeAxis = hingeAxis.normalize();
+	const float hingeMin = -0.4f;
+	const float hingeMax = 0.9f;
+	for (int m = 0; m < 2; m++) {
+		for (int limited = 0; limited < 3; limited++) {
+			ikOptions options;
+			options.method = methods[m];
+			options.iterations = 32;
+			options.tolerance = 1e-3f;
+			const float maxAngle = 0.6f;
+			if (limited == 1) {
+				options.limit = [maxAngle](const uint32_t&, const size_t&, quat4& rotation) {
+					ik::clampAngle(rotation, maxAngle);
+				};
+			}
+			else if (limited == 2) {
+				options.limit = [&hingeAxis, hingeMin, hingeMax](const uint32_t&, const size_t&, quat4& rotation) {
+					ik::hinge(rotation, hingeAxis, hingeMin, hingeMax);
+				};
+			}
+
+			reset();
+			const std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+			const size_t converged = ik::solve(chains, options);
+			const std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+			// every chain counted as converged must really be within tolerance, and limits must hold
+			size_t reached = 0;
+			double worstAngle = 0.0;
+			for (size_t i = 0; i < count; i++) {
+				double miss = 0.0;
+				double angle = 0.0;
+				check(i, miss, angle);
+				worstAngle = std::max(worstAngle, angle);
+				reached += miss <= options.tolerance * 1.01 ? 1 : 0;
+			}
+			const bool agree = reached >= converged;
+
+			// a hinged joint keeps only its twist about the axis, with the twist angle in range
+			double worstSwing = 0.0;
+			double lowestTwist = 0.0;
+			double highestTwist = 0.0;
+			if (limited == 2) {
+				for (size_t k = 0; k < joints * count; k++) {
+					const quat q = quat(chains.rotations.data[0][k], chains.rotations.data[1][k], chains.rotations.data[2][k], chains.rotations.data[3][k]).normalize();
+					const double w = q[0] < 0.0f ? -q[0] : q[0];
+					const double sign = q[0] < 0.0f ? -1.0 : 1.0;
+					const double along = sign * (q[1] * unitHingeAxis[0] + q[2] * unitHingeAxis[1] + q[3] * unitHingeAxis[2]);
+					double swing = 0.0;
+					for (uint32_t c = 0; c < 3; c++) {
+						const double off = sign * q[c + 1] - along * unitHingeAxis[c];
+						swing += off * off;
+					}
+					const double twist = 2.0 * atan2(along, w);
+					worstSwing = std::max(worstSwing, sqrt(swing));
+					lowestTwist = std::min(lowestTwist, twist);
+					highestTwist = std::max(highestTwist, twist);
+				}
+			}
+
+			const bool withinLimits =
+				limited == 0 ||
+				(limited == 1 && worstAngle <= maxAngle + 1e-3) ||
+				(limited == 2 && worstSwing <= 1e-5 && lowestTwist >= hingeMin - 1e-3 && highestTwist <= hingeMax + 1e-3);
+			// ccd is the same algorithm as the operator version, fabrik should converge on nearly every
+			// chain. Limited chains mostly can't reach, a single hinge axis reaches almost none
+			const size_t expected = methods[m] == ikMethod::ccd ? referenceConverged * 99 / 100 : count * 95 / 100;
+			const bool ok = agree && withinLimits && (limited != 0 || converged >= expected);
+			passed = passed && ok;
+			std::cout << "ik::solve " << methodNames[m] << limitNames[limited] << ": "
+				<< converged << " / " << count << " chains in tolerance, largest joint angle " << worstAngle << ", ";
+			if (limited == 2) {
+				std::cout << "twist in [" << lowestTwist << ", " << highestTwist << "], largest swing " << worstSwing << ", ";
+			}
+			std::cout << std::chrono::duration<double, std::nano>(t2 - t1).count() / count << " ns per chain" << (ok ? " PASS" : " FAIL") << std::endl;
+		}
+	}
+
+	return passed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														transform chain
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double matrixError(const mat& a, const mat& b) {
+	double error = 0.0;
+	for (uint32_t col = 0; col < 4; col++) {
+		for (uint32_t row = 0; row < 4; row++) {
+			error = std::max(error, (double)fabsf(a[col][row] - b[col][row]));
+		}
+	}
+
+	return error;
+}
+
+// checks the builder and the tagged transforms against the hand written matrix chain, the
+// builder's step merging and its cache
+bool testTransformChain() {
+	// the matrix version of the eight step chain
+	mat expected = mat::translate(vec4(3.0f, 4.0f, 5.0f));
+	expected = mat::rotateY(30.0f * PI / 180.0f) * expected;
+	expected = mat::rotateZ(20.0f * PI / 180.0f) * expected;
+	expected = mat::rotateX(25.0f * PI / 180.0f) * expected;
+	expected = mat::translate(vec4(-7.0f, -9.0f, -3.0f)) * expected;
+	const float c = 1.0f / sqrtf(2.0f);
+	expected = mat::transform(vec4(c, c), 99.0f * PI / 180.0f, vec4(0.0f, 4.0f, -1.0f)) * expected;
+	const float d = 1.0f / sqrtf(3.0f);
+	expected = mat::rotate(vec4(-d, -d, d), 12.0f * PI / 180.0f) * expected;
+
+	const transformChain chain = builderChain();
+	const double matError = matrixError(chain.toMat(), expected);
+	const double dualquatError = matrixError(dualquatToMat(chain.toDualquat()), expected);
+	bool passed = matError <= 1e-4 && dualquatError <= 1e-4;
+	std::cout << "builder against matrix chain: max error " << std::max(matError, dualquatError) << (passed ? " PASS" : " FAIL") << std::endl;
+
+	// the tagged transforms compose the same chain without the builder
+	const double rigidError = matrixError(rigidChain(), expected);
+	const bool rigidOk = rigidError <= 1e-4;
+	passed = passed && rigidOk;
+	std::cout << "tagged transforms against matrix chain: max error " << rigidError << (rigidOk ? " PASS" : " FAIL") << std::endl;
+
+	// split and cancelling steps merge down to the same chain
+	const transformChain split = transformChain()
+		.translate(vec4(1.0f, 4.0f, 5.0f))
+		.translate(vec4(2.0f, 0.0f, 0.0f))
+		.rotateY(10.0f * PI / 180.0f)
+		.rotateY(20.0f * PI / 180.0f)
+		.euler(vec4(0.0f, 0.0f, 20.0f * PI / 180.0f))
+		.rotateX(25.0f * PI / 180.0f)
+		.rotateZ(5.0f)
+		.rotate(vec4(0.0f, 0.0f, -2.0f), 5.0f)
+		.translate(vec4(-7.0f, -9.0f, -3.0f))
+		.rotate(vec4(2.0f, 2.0f, 0.0f), 99.0f * PI / 180.0f)
+		.translate(vec4(0.0f, 4.0f, -1.0f))
+		.rotate(vec4(-1.0f, -1.0f, 1.0f), 12.0f * PI / 180.0f);
+	const double splitError = matrixError(split.toMat(), expected);
+	const bool merged = split.size() == chain.size() && chain.size() == 8 && splitError <= 1e-4;
+	passed = passed && merged;
+	std::cout << "merged steps: " << split.size() << " of 12 recorded, max error " << splitError << (merged ? " PASS" : " FAIL") << std::endl;
+
+	// the cache returns the same value for equal chains and keeps different chains apart
+	transformChain::clearCache();
+	const double cachedError = matrixError(chain.cachedMat(), expected);
+	const double reusedError = matrixError(builderChain().cachedMat(), expected);
+	const mat other = transformChain().translate(vec4(1.0f, 2.0f, 3.0f)).cachedMat();
+	const bool cached = transformChain::cacheSize() == 2 && cachedError <= 1e-4 && reusedError <= 1e-4 && other[3][2] == 3.0f;
+	passed = passed && cached;
+	std::cout << "cache: " << transformChain::cacheSize() << " entries for 3 lookups" << (cached ? " PASS" : " FAIL") << std::endl;
+
+	// distinct chains past the capacity empty the table instead of growing it
+	size_t largest = 0;
+	bool evictedOk = true;
+	for (size_t i = 0; i <= transformChain::cacheCapacity; i++) {
+		const float x = (float)(i + 1);
+		const mat m = transformChain().translate(vec4(x, 0.0f, 0.0f)).cachedMat();
+		evictedOk = evictedOk && m[3][0] == x;
+		largest = std::max(largest, transformChain::cacheSize());
+	}
+	evictedOk = evictedOk && largest <= transformChain::cacheCapacity && transformChain::cacheSize() < transformChain::cacheCapacity;
+	passed = passed && evictedOk;
+	std::cout << "cache capacity: at most " << largest << " entries for " << transformChain::cacheCapacity + 1 << " chains" << (evictedOk ? " PASS" : " FAIL") << std::endl;
+	transformChain::clearCache();
+
+	return passed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														bounds
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// checks the bound transforms and frustum culling against the operators in double precision and times them
+bool testCulling() {
+	const size_t count = 100003;
+	std::mt19937 rng(29);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	// 60 degree vertical field of view, depth in [-w, w], camera turned and moved back a little
+	const float f = 1.0f / tanf(30.0f * PI / 180.0f);
+	const float aspect = 16.0f / 9.0f;
+	const float zNear = 0.1f;
+	const float zFar = 100.0f;
+	const mat projection(
+		vec4(f / aspect, 0.0f, 0.0f, 0.0f),
+		vec4(0.0f, f, 0.0f, 0.0f),
+		vec4(0.0f, 0.0f, (zFar + zNear) / (zNear - zFar), -1.0f),
+		vec4(0.0f, 0.0f, 2.0f * zFar * zNear / (zNear - zFar), 0.0f)
+	);
+	const mat viewProjection = projection * (mat::rotateY(0.3f) * mat::translate(vec4(0.0f, 0.0f, -5.0f)));
+	const frustum view = frustum::fromMatrix(viewProjection);
+
+	std::vector<dualquat> poses(count);
+	dualquatBuffer poseBuffer(count);
+	std::vector<float> matrices(12 * count);
+	std::vector<float> sphereData(4 * count);
+	std::vector<float> boxData(6 * count);
+	std::vector<float> movedSphereData(4 * count);
+	std::vector<float> movedBoxData(6 * count);
+	sphere_soa spheres, movedSpheres;
+	aabb_soa boxes, movedBoxes;
+	for (int c = 0; c < 4; c++) {
+		spheres.data[c] = sphereData.data() + c * count;
+		movedSpheres.data[c] = movedSphereData.data() + c * count;
+	}
+	for (int c = 0; c < 6; c++) {
+		boxes.data[c] = boxData.data() + c * count;
+		movedBoxes.data[c] = movedBoxData.data() + c * count;
+	}
+	spheres.count = movedSpheres.count = boxes.count = movedBoxes.count = count;
+
+	for (size_t i = 0; i < count; i++) {
+		const quat r = quat(unit(rng), unit(rng), unit(rng), unit(rng)).normalize();
+		poses[i] = dualquat(r, vec4(60.0f * unit(rng), 60.0f * unit(rng), 60.0f * unit(rng)));
+		poseBuffer.set(i, poses[i]);
+		for (int c = 0; c < 3; c++) {
+			spheres.data[c][i] = unit(rng);
+			boxes.data[c][i] = unit(rng);
+			boxes.data[3 + c][i] = 1.1f + unit(rng);
+		}
+		spheres.data[3][i] = 1.25f + 0.75f * unit(rng);
+	}
+	palette::toMatrices(poseBuffer.soa(), matrices.data());
+
+	// plane distances in double, plus how far each bound reaches past them
+	double planes[6][4];
+	for (int p = 0; p < 6; p++) {
+		for (int c = 0; c < 4; c++) {
+			planes[p][c] = view.planes[p][c];
+		}
+	}
+	const auto margin = [&planes](const double* center, const double* extent, const double& radius) {
+		double worst = 1e30;
+		for (int p = 0; p < 6; p++) {
+			double reach = radius;
+			for (int c = 0; c < 3 && extent != nullptr; c++) {
+				reach += fabs(planes[p][c]) * extent[c];
+			}
+			worst = std::min(worst, planes[p][0] * center[0] + planes[p][1] * center[1] + planes[p][2] * center[2] + planes[p][3] + reach);
+		}
+		return worst;
+	};
+
+	std::vector<uint8_t> visible((count + 7) / 8);
+	bool passed = true;
+	const char* poseNames[2] = { "dualquat", "matrix" };
+	for (int path = 0; path < 2; path++) {
+		if (path == 0) {
+			bounds::transform(spheres, poseBuffer.soa(), movedSpheres);
+			bounds::transform(boxes, poseBuffer.soa(), movedBoxes);
+		}
+		else {
+			bounds::transform(spheres, matrices.data(), movedSpheres);
+			bounds::transform(boxes, matrices.data(), movedBoxes);
+		}
+
+		double transformError = 0.0;
+		size_t wrong = 0;
+		size_t shown = 0;
+		for (int kind = 0; kind < 2; kind++) {
+			if (kind == 0) {
+				view.cull(movedSpheres, visible.data());
+			}
+			else {
+				view.cull(movedBoxes, visible.data());
+			}
+
+			for (size_t i = 0; i < count; i++) {
+				const float* const* in = kind == 0 ? spheres.data : boxes.data;
+				float* const* out = kind == 0 ? movedSpheres.data : movedBoxes.data;
+				const mat m = dualquatToMat(poses[i]);
+				const vec4 c = poses[i].transform(vec4(in[0][i], in[1][i], in[2][i], 1.0f));
+				double center[3];
+				double extent[3];
+				for (uint32_t row = 0; row < 3; row++) {
+					center[row] = c[row];
+					extent[row] = 0.0;
+					for (uint32_t col = 0; col < 3 && kind == 1; col++) {
+						extent[row] += fabs(m[col][row]) * in[3 + col][i];
+					}
+					transformError = std::max(transformError, fabs(out[row][i] - center[row]));
+					if (kind == 1) {
+						transformError = std::max(transformError, fabs(out[3 + row][i] - extent[row]));
+					}
+				}
+				if (kind == 0) {
+					transformError = std::max(transformError, (double)fabsf(out[3][i] - in[3][i]));
+				}
+
+				// bounds touching a plane may go either way in float
+				const double reach = margin(center, kind == 1 ? extent : nullptr, kind == 0 ? in[3][i] : 0.0);
+				const bool expected = reach >= 0.0;
+				const bool got = ((visible[i / 8] >> (i % 8)) & 1) != 0;
+				wrong += got != expected && fabs(reach) > 1e-3 ? 1 : 0;
+				shown += got ? 1 : 0;
+			}
+			for (size_t i = count; i < 8 * visible.size(); i++) {
+				wrong += ((visible[i / 8] >> (i % 8)) & 1) != 0 ? 1 : 0;
+			}
+
+			// the fused kernels see the same moved bounds
+			std::vector<uint8_t> fused(visible.size());
+			if (kind == 0) {
+				if (path == 0) {
+					view.cull(spheres, poseBuffer.soa(), fused.data());
+				}
+				else {
+					view.cull(spheres, matrices.data(), fused.data());
+				}
+			}
+			else {
+				if (path == 0) {
+					view.cull(boxes, poseBuffer.soa(), fused.data());
+				}
+				else {
+					view.cull(boxes, matrices.data(), fused.data());
+				}
+			}
+			wrong += fused == visible ? 0 : 1;
+		}
+
+		const bool ok = transformError <= 1e-4 && wrong == 0;
+		passed = passed && ok;
+		std::cout << "bounds by " << poseNames[path] << " poses: max error " << transformError << ", " << wrong
+			<< " wrong of " << 2 * count << " culled, " << shown << " visible" << (ok ? " PASS" : " FAIL") << std::endl;
+	}
+
+	const int rounds = 20;
+	for (int path = 0; path < 2; path++) {
+		for (int kind = 0; kind < 2; kind++) {
+			std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+			for (int round = 0; round < rounds; round++) {
+				if (kind == 0) {
+					if (path == 0) {
+						bounds::transform(spheres, poseBuffer.soa(), movedSpheres);
+					}
+					else {
+						bounds::transform(spheres, matrices.data(), movedSpheres);
+					}
+					view.cull(movedSpheres, visible.data());
+				}
+				else {
+					if (path == 0) {
+						bounds::transform(boxes, poseBuffer.soa(), movedBoxes);
+					}
+					else {
+						bounds::transform(boxes, matrices.data(), movedBoxes);
+					}
+					view.cull(movedBoxes, visible.data());
+				}
+			}
+			std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+			const double separate = std::chrono::duration<double, std::milli>(t2 - t1).count() / rounds;
+
+			t1 = std::chrono::steady_clock::now();
+			for (int round = 0; round < rounds; round++) {
+				if (kind == 0) {
+					if (path == 0) {
+						view.cull(spheres, poseBuffer.soa(), visible.data());
+					}
+					else {
+						view.cull(spheres, matrices.data(), visible.data());
+					}
+				}
+				else {
+					if (path == 0) {
+						view.cull(boxes, poseBuffer.soa(), visible.data());
+					}
+					else {
+						view.cull(boxes, matrices.data(), visible.data());
+					}
+				}
+			}
+			t2 = std::chrono::steady_clock::now();
+			std::cout << "transform and cull " << count << (kind == 0 ? " spheres" : " boxes") << " by " << poseNames[path] << " poses: "
+				<< separate << " ms, fused " << std::chrono::duration<double, std::milli>(t2 - t1).count() / rounds << " ms" << std::endl;
+		}
+	}
+
+	return passed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														pose index
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// share of the exact k nearest that a search found, matched by distance so ties cannot count as misses
+double recall(const std::vector<poseMatch>& exact, const std::vector<poseMatch>& found, const size_t& queries, const uint32_t& k) {
+	size_t hits = 0;
+	for (size_t q = 0; q < queries; q++) {
+		const float kth = exact[q * k + k - 1].distance;
+		for (uint32_t i = 0; i < k; i++) {
+			hits += found[q * k + i].distance <= kth * (1.0f + 1e-6f) ? 1 : 0;
+		}
+	}
+	return (double)hits / (double)(queries * k);
+}
+
+// checks the brute force scan against double precision distances, then the tree against the scan, and times both
+bool testPoseIndex() {
+	const size_t clips = 256;
+	const size_t frames = 800;
+	const size_t count = clips * frames;
+	const size_t queryCount = 2000;
+	const uint32_t k = 8;
+	std::mt19937 rng(41);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_int_distribution<size_t> pick(0, count - 1);
+	bool passed = true;
+
+	// clips of recorded motion, each turned and moved to its own spot like a motion matching database
+	dualquatBuffer poses(count);
+	for (size_t c = 0; c < clips; c++) {
+		const float yaw = PI * unit(rng);
+		const dualquat place(quat(cosf(yaw / 2.0f), 0.0f, sinf(yaw / 2.0f), 0.0f), vec4(5.0f * unit(rng), 0.0f, 5.0f * unit(rng)));
+		for (size_t f = 0; f < frames; f++) {
+			poses.set(c * frames + f, place * recordedPose((float)f / 30.0f, 0.37f * (float)c));
+		}
+	}
+
+	// queries near stored poses, off by up to about 0.1 radians and 0.1 units
+	std::vector<dualquat> queryPoses(queryCount);
+	std::vector<float> queryData(8 * queryCount);
+	for (size_t q = 0; q < queryCount; q++) {
+		const quat nudge = quat(1.0f, 0.05f * unit(rng), 0.05f * unit(rng), 0.05f * unit(rng)).normalize();
+		const dualquat offset(nudge, vec4(0.1f * unit(rng), 0.1f * unit(rng), 0.1f * unit(rng)));
+		queryPoses[q] = offset * poses.get(pick(rng));
+		for (uint32_t c = 0; c < 8; c++) {
+			queryData[8 * q + c] = queryPoses[q][c / 4][c % 4];
+		}
+	}
+	const dualquat_span queries(queryData.data(), queryCount, 8 * sizeof(float));
+
+	poseMetric metric;
+	metric.rotationWeight = 1.0f;
+	metric.translationWeight = 0.5f;
+	std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+	const poseIndex index(poses.soa(), metric);
+	std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+	std::cout << "built index of " << index.size() << " poses in " << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms" << std::endl;
+
+	// scalar reference: every stored pose through the dualquat operators in double precision
+	const size_t referenceCount = 16;
+	double worst = 0.0;
+	std::vector<poseMatch> scanned(queryCount * k);
+	t1 = std::chrono::steady_clock::now();
+	for (size_t q = 0; q < referenceCount; q++) {
+		std::vector<double> distances(count);
+		for (size_t i = 0; i < count; i++) {
+			double distance, angle;
+			poseDistance(queryPoses[q], poses.get(i), distance, angle);
+			distances[i] = metric.rotationWeight * angle + metric.translationWeight * distance;
+		}
+		std::partial_sort(distances.begin(), distances.begin() + k, distances.end());
+
+		index.bruteForce(queryPoses[q], k, scanned.data() + q * k);
+		for (uint32_t i = 0; i < k; i++) {
+			worst = std::max(worst, fabs(scanned[q * k + i].distance - distances[i]));
+		}
+	}
+	t2 = std::chrono::steady_clock::now();
+	const double referenceTime = std::chrono::duration<double, std::milli>(t2 - t1).count() / referenceCount;
+	double distance, angle;
+	poseDistance(queryPoses[0], poses.get(0), distance, angle);
+	worst = std::max(worst, fabs(index.distance(queryPoses[0], poses.get(0)) - (metric.rotationWeight * angle + metric.translationWeight * distance)));
+	const bool scanOk = worst <= 2e-5;
+	passed = passed && scanOk;
+	std::cout << "brute force scan against double precision: max distance error " << worst << (scanOk ? " PASS" : " FAIL") << std::endl;
+
+	t1 = std::chrono::steady_clock::now();
+	for (size_t q = 0; q < queryCount; q++) {
+		index.bruteForce(queries[q], k, scanned.data() + q * k);
+	}
+	t2 = std::chrono::steady_clock::now();
+	const double scanTime = std::chrono::duration<double, std::milli>(t2 - t1).count() / queryCount;
+	std::cout << "per query, k = " << k << ": scalar reference " << referenceTime << " ms, simd brute force " << scanTime << " ms" << std::endl;
+
+	const float epsilons[4] = { 0.0f, 0.1f, 0.25f, 0.5f };
+	std::vector<poseMatch> found(queryCount * k);
+	for (int e = 0; e < 4; e++) {
+		t1 = std::chrono::steady_clock::now();
+		for (size_t q = 0; q < queryCount; q++) {
+			index.nearest(queries[q], k, found.data() + q * k, epsilons[e]);
+		}
+		t2 = std::chrono::steady_clock::now();
+		const double treeTime = std::chrono::duration<double, std::milli>(t2 - t1).count() / queryCount;
+		const double rate = recall(scanned, found, queryCount, k);
+
+		// the exact search may only differ from the scan by rounding at the pruning bounds
+		const bool ok = epsilons[e] > 0.0f || rate >= 0.999;
+		passed = passed && ok;
+		std::cout << "tree, epsilon " << epsilons[e] << ": recall " << rate << ", " << treeTime << " ms per query, "
+			<< scanTime / treeTime << "x brute force" << (ok ? " PASS" : " FAIL") << std::endl;
+	}
+
+	// batched queries give the same matches as one query at a time
+	std::vector<poseMatch> batched(queryCount * k);
+	index.nearest(queries, k, found.data());
+	t1 = std::chrono::steady_clock::now();
+	index.nearest(queries, k, batched.data());
+	t2 = std::chrono::steady_clock::now();
+	size_t mismatches = 0;
+	for (size_t i = 0; i < queryCount * k; i++) {
+		mismatches += batched[i].index == found[i].index && batched[i].distance == found[i].distance ? 0 : 1;
+	}
+	const bool batchOk = mismatches == 0;
+	passed = passed && batchOk;
+	std::cout << "batched tree queries on " << std::thread::hardware_concurrency() << " threads: "
+		<< std::chrono::duration<double, std::milli>(t2 - t1).count() / queryCount << " ms per query, "
+		<< mismatches << " mismatches" << (batchOk ? " PASS" : " FAIL") << std::endl;
+
+	return passed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														arrays
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// checks the array containers round trip interleaved buffers exactly and agree with the value
+// classes, then times them against std::vector of the value classes
+bool testArrays() {
+	const size_t count = 100003;
+	std::mt19937 rng(43);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	bool passed = true;
+
+	// an interleaved vertex with the vec4 in the middle, plus plain quat, dualquat and matrix buffers
+	const size_t vertexFloats = 12;
+	std::vector<float> vertices(vertexFloats * count);
+	std::vector<float> quats(4 * count);
+	std::vector<float> duals(8 * count);
+	std::vector<float> matrices(16 * count);
+	for (std::vector<float>* buffer : { &vertices, &quats, &duals, &matrices }) {
+		for (float& f : *buffer) {
+			f = unit(rng);
+		}
+	}
+
+	const vec4_span positions(vertices.data() + 4, count, vertexFloats * sizeof(float));
+	vec4_array v;
+	quat_array q;
+	dualquat_array d;
+	mat_array m;
+	v.gather(positions);
+	q.gather(quat_span(quats.data(), count, 4 * sizeof(float)));
+	d.gather(dualquat_span(duals.data(), count, 8 * sizeof(float)));
+	m.gather(matrices.data(), count);
+
+	// proxies read the same values the buffers hold
+	size_t wrong = 0;
+	for (size_t i = 0; i < count; i++) {
+		const vec4 a = v[i];
+		const quat b = q[i];
+		const dualquat c = d[i];
+		const mat e = m[i];
+		for (uint32_t k = 0; k < 4; k++) {
+			wrong += a[k] == positions[i][k] ? 0 : 1;
+			wrong += b[k] == quats[4 * i + k] ? 0 : 1;
+		}
+		for (uint32_t k = 0; k < 8; k++) {
+			wrong += c[k / 4][k % 4] == duals[8 * i + k] ? 0 : 1;
+		}
+		for (uint32_t k = 0; k < 16; k++) {
+			wrong += e[k / 4][k % 4] == matrices[16 * i + k] ? 0 : 1;
+		}
+	}
+
+	// scatter writes back exactly the gathered values and leaves the rest of each vertex alone
+	std::vector<float> verticesBack(vertices.size(), 7.0f);
+	std::vector<float> quatsBack(quats.size());
+	std::vector<float> dualsBack(duals.size());
+	std::vector<float> matricesBack(matrices.size());
+	v.scatter(vec4_span(verticesBack.data() + 4, count, vertexFloats * sizeof(float)));
+	q.scatter(quat_span(quatsBack.data(), count, 4 * sizeof(float)));
+	d.scatter(dualquat_span(dualsBack.data(), count, 8 * sizeof(float)));
+	m.scatter(matricesBack.data());
+	for (size_t i = 0; i < vertices.size(); i++) {
+		const size_t k = i % vertexFloats;
+		wrong += verticesBack[i] == (k >= 4 && k < 8 ? vertices[i] : 7.0f) ? 0 : 1;
+	}
+	wrong += quatsBack == quats ? 0 : 1;
+	wrong += dualsBack == duals ? 0 : 1;
+	wrong += matricesBack == matrices ? 0 : 1;
+
+	// writes through proxies, growth and copies
+	dualquat_array grown;
+	for (size_t i = 0; i < 1000; i++) {
+		grown.push_back(d[i]);
+	}
+	grown[3] = d[7];
+	grown[5][2] = 9.0f;
+	const dualquat_array copied(grown);
+	for (size_t i = 0; i < 1000; i++) {
+		const dualquat expected = i == 3 ? d[7] : d[i];
+		for (uint32_t k = 0; k < 8; k++) {
+			const float value = i == 5 && k == 2 ? 9.0f : expected[k / 4][k % 4];
+			wrong += copied.data(k)[i] == value ? 0 : 1;
+		}
+	}
+	wrong += copied.size() == 1000 && copied.capacity() % 16 == 0 ? 0 : 1;
+	wrong += reinterpret_cast<uintptr_t>(copied.data(5)) % 64 == 0 ? 0 : 1;
+	grown.resize(1003);
+	wrong += grown[1001][0] == 0.0f && grown[1002][7] == 0.0f ? 0 : 1;
+
+	const bool exact = wrong == 0;
+	passed = passed && exact;
+	std::cout << "gather, scatter and element proxies on " << count << " entries: " << wrong << " wrong" << (exact ? " PASS" : " FAIL") << std::endl;
+
+	// composing poses, std::vector of dualquat against the array and the palette kernel
+	std::vector<dualquat> a(count);
+	std::vector<dualquat> b(count);
+	std::vector<dualquat> product(count);
+	dualquat_array aArray(count);
+	dualquat_array bArray(count);
+	dualquat_array productArray(count);
+	for (size_t i = 0; i < count; i++) {
+		a[i] = dualquat(quat(unit(rng), unit(rng), unit(rng), unit(rng)).normalize(), vec4(unit(rng), unit(rng), unit(rng)));
+		b[i] = dualquat(quat(unit(rng), unit(rng), unit(rng), unit(rng)).normalize(), vec4(unit(rng), unit(rng), unit(rng)));
+		aArray[i] = a[i];
+		bArray[i] = b[i];
+	}
+
+	const int rounds = 10;
+	std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++) {
+		for (size_t i = 0; i < count; i++) {
+			product[i] = a[i] * b[i];
+		}
+	}
+	std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+	const double vectorTime = std::chrono::duration<double, std::milli>(t2 - t1).count() / rounds;
+
+	t1 = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++) {
+		palette::compose(aArray.soa(), bArray.soa(), productArray.soa());
+	}
+	t2 = std::chrono::steady_clock::now();
+	const double arrayTime = std::chrono::duration<double, std::milli>(t2 - t1).count() / rounds;
+
+	double error = 0.0;
+	for (size_t i = 0; i < count; i++) {
+		for (uint32_t k = 0; k < 8; k++) {
+			error = std::max(error, (double)fabsf(productArray[i][k] - product[i][k / 4][k % 4]));
+		}
+	}
+	const bool composeOk = error <= 1e-5;
+	passed = passed && composeOk;
+	std::cout << "compose " << count << " poses: std::vector<dualquat> " << vectorTime << " ms, dualquat_array "
+		<< arrayTime << " ms, max difference " << error << (composeOk ? " PASS" : " FAIL") << std::endl;
+
+	// conversion from interleaved buffers, transposed against a plain loop copying one float at a
+	// time straight between the buffer and the component arrays
+	t1 = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++) {
+		for (size_t i = 0; i < count; i++) {
+			for (uint32_t k = 0; k < 8; k++) {
+				d.data(k)[i] = duals[8 * i + k];
+			}
+		}
+	}
+	t2 = std::chrono::steady_clock::now();
+	const double loopInTime = std::chrono::duration<double, std::milli>(t2 - t1).count() / rounds;
+
+	t1 = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++) {
+		d.gather(dualquat_span(duals.data(), count, 8 * sizeof(float)));
+	}
+	t2 = std::chrono::steady_clock::now();
+	const double gatherTime = std::chrono::duration<double, std::milli>(t2 - t1).count() / rounds;
+
+	t1 = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++) {
+		for (size_t i = 0; i < count; i++) {
+			for (uint32_t k = 0; k < 8; k++) {
+				dualsBack[8 * i + k] = d.data(k)[i];
+			}
+		}
+	}
+	t2 = std::chrono::steady_clock::now();
+	const double loopOutTime = std::chrono::duration<double, std::milli>(t2 - t1).count() / rounds;
+
+	t1 = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++) {
+		d.scatter(dualquat_span(dualsBack.data(), count, 8 * sizeof(float)));
+	}
+	t2 = std::chrono::steady_clock::now();
+	const double scatterTime = std::chrono::duration<double, std::milli>(t2 - t1).count() / rounds;
+	std::cout << "convert " << count << " interleaved dualquats: plain loop in " << loopInTime << " ms, gather " << gatherTime
+		<< " ms, plain loop out " << loopOutTime << " ms, scatter " << scatterTime << " ms" << std::endl;
+
+	return passed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														trace
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// checks zone recording across threads and ring wrap around, times a zone and exports a trace
+// of a small pipeline to gmath_trace.json
+bool testTrace() {
+	bool passed = true;
+
+	// cost of a zone with recording off and on, enough zones to wrap the ring many times
+	const size_t zones = 1000000;
+	std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < zones; i++) {
+		traceZone zone("disabled");
+	}
+	std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+	const double disabledTime = std::chrono::duration<double, std::nano>(t2 - t1).count() / zones;
+
+	trace::enable(true);
+	trace::clear();
+	t1 = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < zones; i++) {
+		traceZone zone("enabled");
+	}
+	t2 = std::chrono::steady_clock::now();
+	const double enabledTime = std::chrono::duration<double, std::nano>(t2 - t1).count() / zones;
+
+	std::vector<traceEvent> events = trace::collect();
+	bool wrapped = events.size() == trace::ringSize;
+	for (size_t i = 0; i < events.size(); i++) {
+		wrapped = wrapped && strcmp(events[i].name, "enabled") == 0 && events[i].end >= events[i].begin;
+		wrapped = wrapped && (i == 0 || events[i].begin >= events[i - 1].end);
+	}
+	passed = passed && wrapped;
+	std::cout << "zone cost: " << disabledTime << " ns disabled, " << enabledTime << " ns enabled, ring keeps the newest "
+		<< events.size() << " of " << zones << (wrapped ? " PASS" : " FAIL") << std::endl;
+
+	// nested zones on several threads while another thread keeps collecting
+	trace::clear();
+	const size_t threads = 4;
+	const size_t perThread = 10000;
+	std::atomic<bool> done(false);
+	std::thread reader([&done]() {
+		while (!done.load()) {
+			trace::collect();
+		}
+	});
+	// writers stay alive until all have recorded, otherwise a finished thread's ring is handed to the next
+	std::atomic<size_t> started(0);
+	std::vector<std::thread> writers;
+	for (size_t t = 0; t < threads; t++) {
+		writers.emplace_back([&started]() {
+			for (size_t i = 0; i < perThread; i++) {
+				traceZone outer("outer");
+				traceZone inner("inner");
+			}
+			started.fetch_add(1);
+			while (started.load() < threads) {
+				std::this_thread::yield();
+			}
+		});
+	}
+	for (std::thread& writer : writers) {
+		writer.join();
+	}
+	done.store(true);
+	reader.join();
+
+	events = trace::collect();
+	std::vector<size_t> outers(16, 0);
+	std::vector<size_t> inners(16, 0);
+	size_t misplaced = 0;
+	for (const traceEvent& e : events) {
+		if (e.thread >= outers.size()) {
+			misplaced++;
+		}
+		else if (strcmp(e.name, "outer") == 0) {
+			outers[e.thread]++;
+			misplaced += e.depth == 0 ? 0 : 1;
+		}
+		else {
+			inners[e.thread]++;
+			misplaced += e.depth == 1 ? 0 : 1;
+		}
+	}
+	// every inner zone lies in the outer zone recorded just before it on the same thread
+	std::vector<const traceEvent*> open(16, nullptr);
+	for (const traceEvent& e : events) {
+		if (e.thread < open.size() && e.depth == 0) {
+			open[e.thread] = &e;
+		}
+		else if (e.thread < open.size()) {
+			const traceEvent* o = open[e.thread];
+			misplaced += o != nullptr && o->begin <= e.begin && e.end <= o->end ? 0 : 1;
+		}
+	}
+	size_t writerThreads = 0;
+	for (size_t t = 0; t < outers.size(); t++) {
+		if (outers[t] > 0) {
+			writerThreads++;
+			misplaced += outers[t] == perThread && inners[t] == perThread ? 0 : 1;
+		}
+	}
+	const bool threadsOk = writerThreads == threads && misplaced == 0 && events.size() == 2 * threads * perThread;
+	passed = passed && threadsOk;
+	std::cout << threads << " threads with a concurrent reader: " << events.size() << " zones on " << writerThreads
+		<< " threads, " << misplaced << " misplaced" << (threadsOk ? " PASS" : " FAIL") << std::endl;
+
+	// a writer lapping its ring while another thread collects, every event returned must be whole
+	trace::clear();
+	const char* names[2] = { "even", "odd" };
+	std::atomic<bool> writing(true);
+	std::thread lapper([&names, &writing]() {
+		for (uint64_t i = 0; i < 64 * trace::ringSize; i++) {
+			trace::record(names[i % 2], i, i, (uint32_t)(i % 7));
+		}
+		writing.store(false);
+	});
+	size_t torn = 0;
+	size_t checked = 0;
+	while (writing.load()) {
+		for (const traceEvent& e : trace::collect()) {
+			torn += e.name == names[e.begin % 2] && e.end == e.begin && e.depth == e.begin % 7 ? 0 : 1;
+			checked++;
+		}
+	}
+	lapper.join();
+	const bool wholeOk = torn == 0;
+	passed = passed && wholeOk;
+	std::cout << "collecting while the writer laps the ring: " << torn << " torn of " << checked << " events"
+		<< (wholeOk ? " PASS" : " FAIL") << std::endl;
+
+	// a small frame through the batch entry points, zones inside them are recorded when built with GMATH_TRACE
+	trace::clear();
+	const size_t count = 65536;
+	dualquatBuffer deltas(count);
+	dualquatBuffer poses(count);
+	std::vector<float> matrices(12 * count);
+	std::vector<float> sphereData(4 * count);
+	std::vector<uint8_t> visible((count + 7) / 8);
+	sphere_soa spheres;
+	for (int c = 0; c < 4; c++) {
+		spheres.data[c] = sphereData.data() + c * count;
+	}
+	spheres.count = count;
+	for (size_t i = 0; i < count; i++) {
+		deltas.set(i, dualquat(quat(1.0f, 0.001f, 0.002f, 0.0f).normalize(), vec4(0.01f, 0.0f, 0.0f)));
+		spheres.data[3][i] = 0.5f;
+	}
+	const frustum view = frustum::fromMatrix(mat());
+	for (int frame = 0; frame < 3; frame++) {
+		traceZone zone("frame");
+		scan::inclusive(deltas.soa(), poses.soa());
+		palette::toMatrices(poses.soa(), matrices.data());
+		view.cull(spheres, poses.soa(), visible.data());
+	}
+	trace::enable(false);
+
+	events = trace::collect();
+	size_t library = 0;
+	for (const traceEvent& e : events) {
+		library += strcmp(e.name, "frame") == 0 ? 0 : 1;
+	}
+	const bool exported = trace::exportChrome("gmath_trace.json");
+	const std::string json = trace::toChromeJson(events);
+	const bool jsonOk = exported && json.find("\"ph\":\"X\"") != std::string::npos && json.back() == '\n';
+	passed = passed && jsonOk;
+	std::cout << "exported " << events.size() << " zones (" << library << " inside gmath"
+		<< (library == 0 ? ", build with GMATH_TRACE to record them" : "") << ") to gmath_trace.json"
+		<< (jsonOk ? " PASS" : " FAIL") << std::endl;
+
+	return passed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														sweep
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// largest component difference of two dual quaternions, taking b or -b whichever is nearer
+double poseDifference(const dualquat& a, const dualquat& b) {
+	double dot = 0.0;
+	for (uint32_t k = 0; k < 4; k++) {
+		dot += (double)a[0][k] * b[0][k];
+	}
+
+	double error = 0.0;
+	for (uint32_t k = 0; k < 8; k++) {
+		error = std::max(error, fabs((double)a[k / 4][k % 4] - (dot < 0.0 ? -1.0 : 1.0) * b[k / 4][k % 4]));
+	}
+	return error;
+}
+
+// checks sweep samples hit both keys at constant screw velocity, the point sets and swept
+// bounds against the operators, and times sampling against per sample interpolation
+bool testSweep() {
+	const size_t pairs = 2000;
+	const size_t samples = 33;
+	std::mt19937 rng(47);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> positive(0.0f, 1.0f);
+	bool passed = true;
+
+	std::vector<dualquat> froms(pairs);
+	std::vector<dualquat> tos(pairs);
+	for (size_t i = 0; i < pairs; i++) {
+		froms[i] = dualquat(quat(unit(rng), unit(rng), unit(rng), unit(rng)).normalize(), vec4(5.0f * unit(rng), 5.0f * unit(rng), 5.0f * unit(rng)));
+
+		// mostly large turns, some tiny ones and some pure slides, some keys on the far hemisphere
+		const float radians = i % 10 == 0 ? 1e-6f * positive(rng) : (i % 10 == 1 ? 0.0f : PI * positive(rng));
+		const vec4 axis = vec4(unit(rng), unit(rng), unit(rng)).normalize();
+		const float SIN = sinf(radians / 2.0f);
+		const dualquat delta(quat(cosf(radians / 2.0f), SIN * axis[0], SIN * axis[1], SIN * axis[2]), vec4(2.0f * unit(rng), 2.0f * unit(rng), 2.0f * unit(rng)));
+		tos[i] = froms[i] * delta;
+		if (i % 3 == 0) {
+			tos[i] = -1.0f * tos[i];
+		}
+	}
+
+	double endError = 0.0;
+	double velocityError = 0.0;
+	double atError = 0.0;
+	double pointError = 0.0;
+	dualquatBuffer poses(samples);
+	const size_t pointCount = 64;
+	std::vector<float> pointData(4 * pointCount);
+	std::vector<float> moved(4 * pointCount * samples);
+	for (size_t p = 0; p < pointCount; p++) {
+		for (uint32_t k = 0; k < 3; k++) {
+			pointData[4 * p + k] = 2.0f * unit(rng);
+		}
+		// the last one is a direction
+		pointData[4 * p + 3] = p + 1 < pointCount ? 1.0f : 0.0f;
+	}
+	const vec4_span points(pointData.data(), pointCount, 4 * sizeof(float));
+
+	for (size_t i = 0; i < pairs; i++) {
+		const sweep motion(froms[i], tos[i]);
+		motion.sample(poses.soa());
+		motion.transform(points, samples, vec4_span(moved.data(), pointCount * samples, 4 * sizeof(float)));
+
+		endError = std::max(endError, poseDifference(poses.get(0), froms[i]));
+		endError = std::max(endError, poseDifference(poses.get(samples - 1), tos[i]));
+
+		// a screw at constant speed moves by the same relative pose every step
+		const dualquat first = poses.get(0).conjugate() * poses.get(1);
+		for (size_t k = 0; k < samples; k++) {
+			const dualquat pose = poses.get(k);
+			if (k + 1 < samples) {
+				velocityError = std::max(velocityError, poseDifference(pose.conjugate() * poses.get(k + 1), first));
+			}
+			atError = std::max(atError, poseDifference(motion.at((float)k / (float)(samples - 1)), pose));
+
+			for (size_t p = 0; p < pointCount; p++) {
+				const vec4 expected = pose.transform(vec4(pointData[4 * p], pointData[4 * p + 1], pointData[4 * p + 2], pointData[4 * p + 3]));
+				for (uint32_t c = 0; c < 4; c++) {
+					pointError = std::max(pointError, (double)fabsf(moved[4 * (k * pointCount + p) + c] - expected[c]));
+				}
+			}
+		}
+	}
+
+	// long sweeps run the recurrence through several reseeds
+	const size_t longSamples = 1000;
+	dualquatBuffer longPoses(longSamples);
+	for (size_t i = 0; i < pairs; i += 40) {
+		const sweep motion(froms[i], tos[i]);
+		motion.sample(longPoses.soa());
+		for (size_t k = 0; k < longSamples; k++) {
+			atError = std::max(atError, poseDifference(motion.at((float)k / (float)(longSamples - 1)), longPoses.get(k)));
+		}
+	}
+
+	const bool samplesOk = endError <= 1e-4 && velocityError <= 1e-4 && atError <= 1e-4 && pointError <= 1e-4;
+	passed = passed && samplesOk;
+	std::cout << pairs << " sweeps of " << samples << " samples: key error " << endError << ", step error " << velocityError
+		<< ", at() error " << atError << ", point error " << pointError << (samplesOk ? " PASS" : " FAIL") << std::endl;
+
+	// swept boxes against the box corners at many times along the motion
+	const size_t dense = 1025;
+	const size_t boundSamples[3] = { 2, 8, 32 };
+	for (const size_t n : boundSamples) {
+		size_t outside = 0;
+		double looseness = 0.0;
+		for (size_t i = 0; i < pairs; i += 4) {
+			const sweep motion(froms[i], tos[i]);
+			const float center[3] = { unit(rng), unit(rng), unit(rng) };
+			const float halfExtents[3] = { 0.1f + positive(rng), 0.1f + positive(rng), 0.1f + positive(rng) };
+			float sweptCenter[3];
+			float sweptHalfExtents[3];
+			motion.bounds(center, halfExtents, n, sweptCenter, sweptHalfExtents);
+
+			double lo[3] = { 1e30, 1e30, 1e30 };
+			double hi[3] = { -1e30, -1e30, -1e30 };
+			for (size_t k = 0; k < dense; k++) {
+				const dualquat pose = motion.at((float)k / (float)(dense - 1));
+				for (int corner = 0; corner < 8; corner++) {
+					const vec4 p = pose.transform(vec4(
+						center[0] + (corner & 1 ? halfExtents[0] : -halfExtents[0]),
+						center[1] + (corner & 2 ? halfExtents[1] : -halfExtents[1]),
+						center[2] + (corner & 4 ? halfExtents[2] : -halfExtents[2]),
+						1.0f
+					));
+					for (int c = 0; c < 3; c++) {
+						lo[c] = std::min(lo[c], (double)p[c]);
+						hi[c] = std::max(hi[c], (double)p[c]);
+						outside += fabs(p[c] - sweptCenter[c]) <= sweptHalfExtents[c] + 1e-4 ? 0 : 1;
+					}
+				}
+			}
+			for (int c = 0; c < 3; c++) {
+				looseness = std::max(looseness, 2.0 * sweptHalfExtents[c] - (hi[c] - lo[c]));
+			}
+		}
+
+		const bool ok = outside == 0;
+		passed = passed && ok;
+		std::cout << "swept boxes from " << n << " samples: " << outside << " corner positions outside, at most "
+			<< looseness << " larger than the dense bounds" << (ok ? " PASS" : " FAIL") << std::endl;
+	}
+
+	// sampling every object at 16 sub frame times
+	const size_t perObject = 16;
+	dualquatBuffer blur(perObject);
+	std::vector<dualquat> blurPoses(perObject);
+	std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < pairs; i++) {
+		const sweep motion(froms[i], tos[i]);
+		for (size_t k = 0; k < perObject; k++) {
+			blurPoses[k] = motion.at((float)k / (float)(perObject - 1));
+		}
+	}
+	std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+	const double perSample = std::chrono::duration<double, std::micro>(t2 - t1).count() / pairs;
+
+	t1 = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < pairs; i++) {
+		const sweep motion(froms[i], tos[i]);
+		motion.sample(blur.soa());
+	}
+	t2 = std::chrono::steady_clock::now();
+	std::cout << perObject << " poses per object: at() per sample " << perSample << " us, sample() "
+		<< std::chrono::duration<double, std::micro>(t2 - t1).count() / pairs << " us" << std::endl;
+
+	return passed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														views
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// largest difference of the components, relative to the size of b, plus a flag when the w lanes
+// differ in any bit, sign included
+double viewDifference(const vec4& a, const vec4& b, bool* wDiffers = nullptr) {
+	double error = 0.0;
+	for (uint32_t c = 0; c < 4; c++) {
+		error = std::max(error, fabs((double)a[c] - b[c]) / (1.0 + fabs((double)b[c])));
+	}
+	if (wDiffers != nullptr) {
+		*wDiffers = *wDiffers || memcmp(&a.data[3], &b.data[3], sizeof(float)) != 0;
+	}
+	return error;
+}
+
+double viewDifference(const quat& a, const quat& b) {
+	return viewDifference(vec4(a[0], a[1], a[2], a[3]), vec4(b[0], b[1], b[2], b[3]));
+}
+
+double viewDifference(const dualquat& a, const dualquat& b) {
+	return std::max(viewDifference(a[0], b[0]), viewDifference(a[1], b[1]));
+}
+
+// checks every view operator and span transform against the owning classes on aligned, offset
+// and strided buffers
+bool testViews() {
+	const size_t count = 1003;
+	std::mt19937 rng(53);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> positive(0.05f, 1.0f);
+	bool passed = true;
+
+	// offset and stride in floats: aligned, shifted by one float, interleaved with other data
+	const size_t layouts[3][2] = { { 0, 8 }, { 1, 8 }, { 3, 11 } };
+	const char* layoutNames[3] = { "aligned", "offset", "strided" };
+
+	std::vector<vec4> values(count);
+	std::vector<quat> rotations(count);
+	std::vector<dualquat> poses(count);
+	for (size_t i = 0; i < count; i++) {
+		// every fourth vector is all negative, w is 1, 0 or anything
+		const float sign = i % 4 == 0 ? -1.0f : 1.0f;
+		const float w = i % 3 == 0 ? 1.0f : (i % 3 == 1 ? 0.0f : unit(rng));
+		values[i] = i % 4 == 0
+			? vec4(-positive(rng), -positive(rng), -positive(rng), w)
+			: vec4(sign * unit(rng), unit(rng), unit(rng), w);
+		rotations[i] = quat(unit(rng), unit(rng), unit(rng), unit(rng));
+		poses[i] = dualquat(rotations[i].normalize(), vec4(unit(rng), unit(rng), unit(rng)));
+	}
+	const mat m = mat::transform(vec4(0.3f, -0.5f, 0.8f).normalize(), 0.7f, vec4(1.0f, -2.0f, 0.5f)) * (0.5f * mat());
+	const vec4 translation(0.25f, -0.5f, 1.5f, 0.0f);
+
+	for (int layout = 0; layout < 3; layout++) {
+		const size_t offset = layouts[layout][0];
+		const size_t stride = layouts[layout][1];
+		float* base = static_cast<float*>(_mm_malloc((offset + stride * count + 8) * sizeof(float), 16));
+		float* other = static_cast<float*>(_mm_malloc((offset + stride * count + 8) * sizeof(float), 16));
+		const vec4_span vectors(base + offset, count, stride * sizeof(float));
+		const quat_span quats(base + offset, count, stride * sizeof(float));
+		const dualquat_span duals(base + offset, count, stride * sizeof(float));
+		const vec4_span otherVectors(other + offset, count, stride * sizeof(float));
+
+		double error = 0.0;
+		bool wDiffers = false;
+
+		// vec4_view against vec4
+		for (size_t i = 0; i < count; i++) {
+			vectors[i] = values[i];
+			otherVectors[i] = values[(i + 1) % count];
+		}
+		for (size_t i = 0; i < count; i++) {
+			const vec4_view a = vectors[i];
+			const vec4_view b = otherVectors[i];
+			const vec4& va = values[i];
+			const vec4& vb = values[(i + 1) % count];
+			error = std::max(error, viewDifference(vec4(a), va, &wDiffers));
+			error = std::max(error, viewDifference(vec4(a[0], a[1], a[2], a[3]), va));
+			error = std::max(error, viewDifference(-a, -va));
+			error = std::max(error, viewDifference(a * b, va * vb));
+			error = std::max(error, viewDifference(2.5f * a, 2.5f * va));
+			error = std::max(error, viewDifference(a * 2.5f, va * 2.5f));
+			error = std::max(error, viewDifference(a / 2.5f, va / 2.5f));
+			error = std::max(error, viewDifference(a + b, va + vb));
+			error = std::max(error, viewDifference(a - b, va - vb));
+			error = std::max(error, viewDifference(a.multiply(b), va.multiply(vb)));
+			error = std::max(error, viewDifference(a.normalize(), va.normalize()));
+			error = std::max(error, viewDifference(m * a, m * va));
+			error = std::max(error, fabs((double)a.dot(b) - va.dot(vb)) / (1.0 + fabs((double)va.dot(vb))));
+			error = std::max(error, fabs((double)a.magnitude() - va.magnitude()) / (1.0 + va.magnitude()));
+			error = std::max(error, fabs((double)a.magnitude2() - va.magnitude2()) / (1.0 + va.magnitude2()));
+		}
+
+		// view to view assignment, then the span transforms, in place and into another buffer
+		for (size_t i = 0; i < count; i++) {
+			otherVectors[i] = vectors[i];
+			error = std::max(error, viewDifference(vec4(otherVectors[i]), values[i], &wDiffers));
+		}
+		const quat& q = rotations[7];
+		q.transform(vectors, otherVectors);
+		for (size_t i = 0; i < count; i++) {
+			error = std::max(error, viewDifference(vec4(otherVectors[i]), q.normalize().transform(values[i]), &wDiffers));
+		}
+		m.transform(vectors, otherVectors);
+		for (size_t i = 0; i < count; i++) {
+			error = std::max(error, viewDifference(vec4(otherVectors[i]), m * values[i], &wDiffers));
+		}
+		poses[7].transform(vectors, otherVectors);
+		for (size_t i = 0; i < count; i++) {
+			error = std::max(error, viewDifference(vec4(otherVectors[i]), poses[7].transform(values[i]), &wDiffers));
+		}
+		poses[7].transform(vectors, vectors);
+		for (size_t i = 0; i < count; i++) {
+			error = std::max(error, viewDifference(vec4(vectors[i]), poses[7].transform(values[i]), &wDiffers));
+		}
+
+		// quat_view against quat
+		for (size_t i = 0; i < count; i++) {
+			quats[i] = rotations[i];
+		}
+		for (size_t i = 0; i < count; i++) {
+			const quat_view a = quats[i];
+			const quat_view b = quats[(i + 1) % count];
+			const quat& qa = rotations[i];
+			const quat& qb = rotations[(i + 1) % count];
+			error = std::max(error, viewDifference(quat(a), qa));
+			error = std::max(error, viewDifference(-a, -qa));
+			error = std::max(error, viewDifference(a.conjugate(), qa.conjugate()));
+			error = std::max(error, viewDifference(a.inverse(), qa.inverse()));
+			error = std::max(error, viewDifference(a.normalize(), qa.normalize()));
+			error = std::max(error, viewDifference(a * b, qa * qb));
+			error = std::max(error, viewDifference(2.5f * a, 2.5f * qa));
+			error = std::max(error, viewDifference(a * 2.5f, qa * 2.5f));
+			error = std::max(error, viewDifference(a / 2.5f, qa / 2.5f));
+			error = std::max(error, viewDifference(a + b, qa + qb));
+			error = std::max(error, viewDifference(a - b, qa - qb));
+			error = std::max(error, fabs((double)a.norm() - qa.norm()) / (1.0 + qa.norm()));
+			error = std::max(error, viewDifference(a.transform(values[i]), qa.transform(values[i]), &wDiffers));
+			error = std::max(error, viewDifference(a.transform(values[i], translation), qa.transform(values[i], translation), &wDiffers));
+		}
+
+		// dualquat_view against dualquat
+		for (size_t i = 0; i < count; i++) {
+			duals[i] = poses[i];
+		}
+		for (size_t i = 0; i < count; i++) {
+			const dualquat_view a = duals[i];
+			const dualquat_view b = duals[(i + 1) % count];
+			const dualquat& da = poses[i];
+			const dualquat& db = poses[(i + 1) % count];
+			error = std::max(error, viewDifference(dualquat(a), da));
+			error = std::max(error, viewDifference(a.conjugate(), da.conjugate()));
+			error = std::max(error, viewDifference(a.dualConjugate(), da.dualConjugate()));
+			error = std::max(error, viewDifference(a.inverse(), da.inverse()));
+			error = std::max(error, viewDifference(a.normalize(), da.normalize()));
+			error = std::max(error, viewDifference(a * b, da * db));
+			error = std::max(error, viewDifference(2.5f * a, 2.5f * da));
+			error = std::max(error, viewDifference(a * 2.5f, da * 2.5f));
+			error = std::max(error, viewDifference(a + b, da + db));
+			error = std::max(error, viewDifference(a - b, da - db));
+			error = std::max(error, viewDifference(a.transform(values[i]), da.transform(values[i]), &wDiffers));
+		}
+
+		_mm_free(base);
+		_mm_free(other);
+
+		const bool ok = error <= 1e-5 && !wDiffers;
+		passed = passed && ok;
+		std::cout << "views and spans, " << layoutNames[layout] << ": max relative error " << error
+			<< (wDiffers ? ", w changed" : "") << (ok ? " PASS" : " FAIL") << std::endl;
+	}
+
+	return passed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														unit types
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// checks unit_quat, unit_dualquat and the tagged rigid transforms against the general quat and
+// dualquat operators on random rotations and translations
+bool testUnit() {
+	const size_t count = 10000;
+	std::mt19937 rng(59);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> angle(-PI, PI);
+	double quatError = 0.0;
+	double dualquatError = 0.0;
+	double rigidError = 0.0;
+	bool wDiffers = false;
+
+	for (size_t i = 0; i < count; i++) {
+		const quat a(unit(rng), unit(rng), unit(rng), unit(rng));
+		const quat b(unit(rng), unit(rng), unit(rng), unit(rng));
+		const vec4 t(unit(rng), unit(rng), unit(rng));
+		const vec4 s(unit(rng), unit(rng), unit(rng));
+		const float w = i % 3 == 0 ? 1.0f : (i % 3 == 1 ? 0.0f : unit(rng));
+		const vec4 v(unit(rng), unit(rng), unit(rng), w);
+
+		const unit_quat ua(a);
+		const unit_quat ub(b);
+		const quat na = a.normalize();
+		const quat nb = b.normalize();
+		quatError = std::max(quatError, viewDifference(ua.toQuat(), na));
+		quatError = std::max(quatError, fabs((double)ua.norm() - 1.0));
+		quatError = std::max(quatError, viewDifference(vec4(ua[0], ua[1], ua[2], ua[3]), vec4(na[0], na[1], na[2], na[3])));
+		quatError = std::max(quatError, viewDifference((ua * ub).toQuat(), na * nb));
+		quatError = std::max(quatError, viewDifference((-ua).toQuat(), -na));
+		quatError = std::max(quatError, viewDifference(ua.conjugate().toQuat(), na.conjugate()));
+		quatError = std::max(quatError, viewDifference(ua.inverse().toQuat(), na.inverse()));
+		quatError = std::max(quatError, viewDifference(ua.transform(v), na.transform(v), &wDiffers));
+		quatError = std::max(quatError, viewDifference(ua.transform(v, t), na.transform(v, t), &wDiffers));
+
+		// the axis is left unnormalized for unit_quat, the batch builder wants it unit length
+		const vec4 axis(unit(rng), unit(rng), unit(rng));
+		const vec4 unitAxis = axis.normalize();
+		const float radians = angle(rng);
+		quat built;
+		quat::fromAxisAngle(&unitAxis, &radians, &built, 1);
+		quatError = std::max(quatError, viewDifference(unit_quat::fromAxisAngle(axis, radians).toQuat(), built));
+
+		const dualquat da(na, t);
+		const dualquat db(nb, s);
+		const unit_dualquat uda(ua, t);
+		const unit_dualquat udb(ub, s);
+		dualquatError = std::max(dualquatError, viewDifference(uda.toDualquat(), da));
+		dualquatError = std::max(dualquatError, viewDifference(unit_dualquat(2.5f * da).toDualquat(), da));
+		dualquatError = std::max(dualquatError, viewDifference(unit_dualquat(ua).toDualquat(), dualquat(na)));
+		dualquatError = std::max(dualquatError, viewDifference((uda * udb).toDualquat(), da * db));
+		dualquatError = std::max(dualquatError, viewDifference(uda.conjugate().toDualquat(), da.conjugate()));
+		dualquatError = std::max(dualquatError, viewDifference(uda.inverse().toDualquat(), da.inverse()));
+		dualquatError = std::max(dualquatError, viewDifference(uda.transform(v), da.transform(v), &wDiffers));
+		dualquatError = std::max(dualquatError, viewDifference(uda.rotation().toQuat(), na));
+		dualquatError = std::max(dualquatError, viewDifference(uda.translation(), t));
+
+		// composition of the tagged transforms against the dualquat products
+		const rotation ra(ua);
+		const translation ts(s);
+		const rigid_motion ma(ua, t);
+		const rigid_motion mb(udb);
+		rigidError = std::max(rigidError, viewDifference((ra * ts).toDualquat(), dualquat(na) * dualquat(quat(1.0f), s)));
+		rigidError = std::max(rigidError, viewDifference((ts * ra).toDualquat(), dualquat(quat(1.0f), s) * dualquat(na)));
+		rigidError = std::max(rigidError, viewDifference((ma * mb).toDualquat(), da * db));
+		rigidError = std::max(rigidError, viewDifference((ra * mb).toDualquat(), dualquat(na) * db));
+		rigidError = std::max(rigidError, viewDifference(ma.inverse().toDualquat(), da.inverse()));
+		rigidError = std::max(rigidError, viewDifference(ma.transform(v), da.transform(v), &wDiffers));
+		const vec4 point(v[0], v[1], v[2], 1.0f);
+		rigidError = std::max(rigidError, viewDifference(ma.toMat() * point, da.transform(point)));
+	}
+
+	const bool quatOk = quatError <= 1e-5;
+	const bool dualquatOk = dualquatError <= 1e-5;
+	const bool rigidOk = rigidError <= 1e-5 && !wDiffers;
+	std::cout << "unit_quat against quat: max relative error " << quatError << (quatOk ? " PASS" : " FAIL") << std::endl;
+	std::cout << "unit_dualquat against dualquat: max relative error " << dualquatError << (dualquatOk ? " PASS" : " FAIL") << std::endl;
+	std::cout << "rigid against dualquat: max relative error " << rigidError
+		<< (wDiffers ? ", w changed" : "") << (rigidOk ? " PASS" : " FAIL") << std::endl;
+
+	return quatOk && dualquatOk && rigidOk;
+}
+
+// usage:
+//   DualQuaternion                   runs the fixed eight step chain timing tests
+//   DualQuaternion --precision       runs random chains through every path and reports speed and error
+//     --lengths 8,64,512             chain lengths to test
+//     --chains N                     number of random chains per length
+//     --renorm K                     renormalize every K steps (0 = never)
+//     --seed S                       random seed
+//     --csv                          emit csv instead of a table
+//   --counters                       adds per operation hardware counters (Linux only) to the timing and precision runs
+//   DualQuaternion --trig            checks batched sin / cos and rotation constructors against libm
+//   DualQuaternion --palette         checks and times the batch palette builders
+//   DualQuaternion --scan            checks and times the parallel prefix scan of pose deltas
+//   DualQuaternion --posebuffer      stress tests the pose buffer with concurrent readers
+//   DualQuaternion --qtangent        checks and times qtangent encode, decode, packing and skinning
+//   DualQuaternion --keyframes       checks and times offline and streaming keyframe reduction
+//   DualQuaternion --ik              checks and times the batched ik solvers
+//   DualQuaternion --chain           checks the transform chain builder and tagged transforms against the matrix chain
+//   DualQuaternion --cull            checks and times bounding volume transforms and frustum culling
+//   DualQuaternion --poseindex       checks nearest pose queries against brute force, reports recall and latency
+//   DualQuaternion --arrays          checks and times the soa array containers
+//   DualQuaternion --trace           checks trace zones and writes gmath_trace.json
+//   DualQuaternion --sweep           checks and times sub frame sweep sampling and swept bounds
+//   DualQuaternion --views           checks the view operators and span transforms against the owning classes
+//   DualQuaternion --unit            checks the unit and tagged rigid types against the quat and dualquat operators
+int main(int argc, char** argv) {
+	bool precision = false;
+	bool trigCheck = false;
+	bool paletteCheck = false;
+	bool scanCheck = false;
+	bool poseBufferCheck = false;
+	bool qtangentCheck = false;
+	bool keyframesCheck = false;
+	bool ikCheck = false;
+	bool chainCheck = false;
+	bool cullCheck = false;
+	bool poseIndexCheck = false;
+	bool arraysCheck = false;
+	bool traceCheck = false;
+	bool sweepCheck = false;
+	bool viewsCheck = false;
+	bool unitCheck = false;
+	precisionOptions options;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string arg(argv[i]);
+		const bool hasValue = i + 1 < argc;
+		if (arg == "--precision") {
+			precision = true;
+		}
+		else if (arg == "--trig") {
+			trigCheck = true;
+		}
+		else if (arg == "--palette") {
+			paletteCheck = true;
+		}
+		else if (arg == "--scan") {
+			scanCheck = true;
+		}
+		else if (arg == "--posebuffer") {
+			poseBufferCheck = true;
+		}
+		else if (arg == "--qtangent") {
+			qtangentCheck = true;
+		}
+		else if (arg == "--keyframes") {
+			keyframesCheck = true;
+		}
+		else if (arg == "--ik") {
+			ikCheck = true;
+		}
+		else if (arg == "--chain") {
+			chainCheck = true;
+		}
+		else if (arg == "--cull") {
+			cullCheck = true;
+		}
+		else if (arg == "--poseindex") {
+			poseIndexCheck = true;
+		}
+		else if (arg == "--arrays") {
+			arraysCheck = true;
+		}
+		else if (arg == "--trace") {
+			traceCheck = true;
+		}
+		else if (arg == "--sweep") {
+			sweepCheck = true;
+		}
+		else if (arg == "--views") {
+			viewsCheck = true;
+		}
+		else if (arg == "--unit") {
+			unitCheck = true;
+		}
+		else if (arg == "--counters") {
+			countersEnabled = true;
+		}
+		else if (arg == "--csv") {
+			options.csv = true;
+		}
+		else if (arg == "--lengths" && hasValue) {
+			options.lengths = parseLengths(argv[++i]);
+		}
+		else if (arg == "--chains" && hasValue) {
+			options.chains = std::atoi(argv[++i]);
+		}
+		else if (arg == "--renorm" && hasValue) {
+			options.renorm = std::atoi(argv[++i]);
+		}
+		else if (arg == "--seed" && hasValue) {
+			options.seed = (unsigned int)std::atoi(argv[++i]);
+		}
+		else {
+			std::cerr << "Unknown argument: " << arg << std::endl;
+			return 1;
+		}
+	}
+
+	if (countersEnabled) {
+		std::string reason;
+		if (!counters.open(reason)) {
+			std::cerr << "Hardware counters unavailable (" << reason << "), continuing without them." << std::endl;
+			countersEnabled = false;
+		}
+		else if (!reason.empty()) {
+			std::cerr << "Some hardware counters unavailable (" << reason << ")." << std::endl;
+		}
+	}
+
+	if (trigCheck) {
+		return testTrigAccuracy() ? 0 : 1;
+	}
+
+	if (paletteCheck) {
+		return testPalette() ? 0 : 1;
+	}
+
+	if (scanCheck) {
+		return testScan() ? 0 : 1;
+	}
+
+	if (poseBufferCheck) {
+		return testPoseBufferStress() ? 0 : 1;
+	}
+
+	if (qtangentCheck) {
+		return testQTangent() ? 0 : 1;
+	}
+
+	if (keyframesCheck) {
+		return testKeyframes() ? 0 : 1;
+	}
+
+	if (ikCheck) {
+		return testIk() ? 0 : 1;
+	}
+
+	if (chainCheck) {
+		return testTransformChain() ? 0 : 1;
+	}
+
+	if (cullCheck) {
+		return testCulling() ? 0 : 1;
+	}
+
+	if (poseIndexCheck) {
+		return testPoseIndex() ? 0 : 1;
+	}
+
+	if (arraysCheck) {
+		return testArrays() ? 0 : 1;
+	}
+
+	if (traceCheck) {
+		return testTrace() ? 0 : 1;
+	}
+
+	if (sweepCheck) {
+		return testSweep() ? 0 : 1;
+	}
+
+	if (viewsCheck) {
+		return testViews() ? 0 : 1;
+	}
+
+	if (unitCheck) {
+		return testUnit() ? 0 : 1;
+	}
+
+	if (precision) {
+		runPrecisionBenchmark(options);
+		return 0;
+	}
+
 	std::cout << "Concatenating Matrix transforms test: " << std::endl;
 	runTest(testConcatTransformsMatrix, numTrials);
 	std::cout << "Concatenating quaternion and translation vectors test: " << std::endl;
 	runTest(testConcatTransformQuatAndVec, numTrials);
 	std::cout << "Concatenating dual quaternions test: " << std::endl;
 	runTest(testConcatTransformDualQuat, numTrials);
+	std::cout << "Concatenating tagged rotation and translation transforms test: " << std::endl;
+	runTest(testConcatTransformRigid, numTrials);
+	std::cout << "Concatenating with the transform chain builder test: " << std::endl;
+	runTest(testConcatTransformBuilder, numTrials);
+	std::cout << "Concatenating with the cached transform chain builder test: " << std::endl;
+	runTest(testConcatTransformBuilderCached, numTrials);
 	std::system("pause");
 	return 1;
 }
\ No newline at end of file
@@ -144,6 +144,24 @@ mat mat::transform(const vec4& a, const float& radians, const vec4& t) {
 	);
 }
 
+void mat::transform(const vec4_span& in, const vec4_span& out) const {
+	GMATH_TRACE_ZONE("mat::transform");
+	const __m128 col1 = _mm_load_ps(data[0].data);
+	const __m128 col2 = _mm_load_ps(data[1].data);
+	const __m128 col3 = _mm_load_ps(data[2].data);
+	const __m128 col4 = _mm_load_ps(data[3].data);
+
+	for (size_t i = 0; i < in.size(); i++) {
+		const vec4_view src = in[i];
+		const __m128 v = src.load();
+		const __m128 xMCol1 = _mm_mul_ps(col1, _mm_replicate_x_ps(v));
+		const __m128 xMCol2 = _mm_mul_ps(col2, _mm_replicate_y_ps(v));
+		const __m128 xMCol3 = _mm_mul_ps(col3, _mm_replicate_z_ps(v));
+		const __m128 xMCol4 = _mm_mul_ps(col4, _mm_replicate_w_ps(v));
+		out[i].store(_mm_add_ps(_mm_add_ps(_mm_add_ps(xMCol1, xMCol2), xMCol3), xMCol4));
+	}
+}
+
 vec4 gmath::operator*(const mat& m, const vec4& v) {
 	const __m128 colvec = _mm_load_ps(v.data);
 
@@ -165,6 +183,27 @@ vec4 gmath::operator*(const mat& m, const vec4& v) {
 	return vec4(_mm_add_ps(_mm_add_ps(_mm_add_ps(xMCol1, xMCol2), xMCol3), xMCol4));
 }
 
+vec4 gmath::operator*(const mat& m, const vec4_view& v) {
+	const __m128 colvec = v.load();
+
+	const __m128 xxxx = _mm_replicate_x_ps(colvec);
+	const __m128 yyyy = _mm_replicate_y_ps(colvec);
+	const __m128 zzzz = _mm_replicate_z_ps(colvec);
+	const __m128 wwww = _mm_replicate_w_ps(colvec);
+
+	const __m128 col1 = _mm_load_ps(m[0].data);
+	const __m128 col2 = _mm_load_ps(m[1].data);
+	const __m128 col3 = _mm_load_ps(m[2].data);
+	const __m128 col4 = _mm_load_ps(m[3].data);
+
+	const __m128 xMCol1 = _mm_mul_ps(col1, xxxx);
+	const __m128 xMCol2 = _mm_mul_ps(col2, yyyy);
+	const __m128 xMCol3 = _mm_mul_ps(col3, zzzz);
+	const __m128 xMCol4 = _mm_mul_ps(col4, wwww);
+
+	return vec4(_mm_add_ps(_mm_add_ps(_mm_add_ps(xMCol1, xMCol2), xMCol3), xMCol4));
+}
+
 mat gmath::operator*(const mat& m1, const mat& m2) {
 	return mat(m1 * m2[0], m1 * m2[1], m1 * m2[2], m1 * m2[3]);
 }
@@ -0,0 +1,112 @@
+#include "..\include\gmath.hpp"
+
+using namespace gmath;
+
+// writes the row major 3x4 matrices of the n (<= 4) lanes of d to matrices
+static void storeMatrices(const dualquat4& d, float* matrices, const size_t& n, const bool& unit) {
+	const __m128* r = d.data[0].data;
+	const __m128* q = d.data[1].data;
+	const __m128 two = _mm_set1_ps(2.0f);
+
+	// homogeneous form of the rotation matrix, exact for any non zero real part once scaled by s
+	const __m128 s = unit ? _mm_set1_ps(1.0f) : _mm_div_ps(_mm_set1_ps(1.0f), d.data[0].norm2());
+	const __m128 s2 = _mm_mul_ps(two, s);
+
+	const __m128 ww = _mm_mul_ps(r[0], r[0]);
+	const __m128 xx = _mm_mul_ps(r[1], r[1]);
+	const __m128 yy = _mm_mul_ps(r[2], r[2]);
+	const __m128 zz = _mm_mul_ps(r[3], r[3]);
+	const __m128 xy = _mm_mul_ps(r[1], r[2]);
+	const __m128 xz = _mm_mul_ps(r[1], r[3]);
+	const __m128 yz = _mm_mul_ps(r[2], r[3]);
+	const __m128 wx = _mm_mul_ps(r[0], r[1]);
+	const __m128 wy = _mm_mul_ps(r[0], r[2]);
+	const __m128 wz = _mm_mul_ps(r[0], r[3]);
+
+	// t = 2 q r* = 2 (rw qv - qw rv + rv x qv)
+	const __m128 tx = _mm_mul_ps(s2, _mm_add_ps(
+		_mm_sub_ps(_mm_mul_ps(r[0], q[1]), _mm_mul_ps(q[0], r[1])),
+		_mm_sub_ps(_mm_mul_ps(r[2], q[3]), _mm_mul_ps(r[3], q[2]))
+	));
+	const __m128 ty = _mm_mul_ps(s2, _mm_add_ps(
+		_mm_sub_ps(_mm_mul_ps(r[0], q[2]), _mm_mul_ps(q[0], r[2])),
+		_mm_sub_ps(_mm_mul_ps(r[3], q[1]), _mm_mul_ps(r[1], q[3]))
+	));
+	const __m128 tz = _mm_mul_ps(s2, _mm_add_ps(
+		_mm_sub_ps(_mm_mul_ps(r[0], q[3]), _mm_mul_ps(q[0], r[3])),
+		_mm_sub_ps(_mm_mul_ps(r[1], q[2]), _mm_mul_ps(r[2], q[1]))
+	));
+
+	__m128 rows[3][4] = {
+		{
+			_mm_mul_ps(s, _mm_sub_ps(_mm_add_ps(ww, xx), _mm_add_ps(yy, zz))),
+			_mm_mul_ps(s2, _mm_sub_ps(xy, wz)),
+			_mm_mul_ps(s2, _mm_add_ps(xz, wy)),
+			tx
+		},
+		{
+			_mm_mul_ps(s2, _mm_add_ps(xy, wz)),
+			_mm_mul_ps(s, _mm_sub_ps(_mm_add_ps(ww, yy), _mm_add_ps(xx, zz))),
+			_mm_mul_ps(s2, _mm_sub_ps(yz, wx)),
+			ty
+		},
+		{
+			_mm_mul_ps(s2, _mm_sub_ps(xz, wy)),
+			_mm_mul_ps(s2, _mm_add_ps(yz, wx)),
+			_mm_mul_ps(s, _mm_sub_ps(_mm_add_ps(ww, zz), _mm_add_ps(xx, yy))),
+			tz
+		}
+	};
+
+	// after the transpose rows[row][lane] holds that row of the lane's matrix
+	for (int row = 0; row < 3; row++) {
+		_MM_TRANSPOSE4_PS(rows[row][0], rows[row][1], rows[row][2], rows[row][3]);
+		for (size_t lane = 0; lane < n; lane++) {
+			_mm_storeu_ps(matrices + 12 * lane + 4 * row, rows[row][lane]);
+		}
+	}
+}
+
+static dualquat4 relativePose(const dualquat4& a, const dualquat4& b, const bool& unit) {
+	return (unit ? a.conjugate() : a.inverse()) * b;
+}
+
+void palette::compose(const dualquat_soa& a, const dualquat_soa& b, const dualquat_soa& out) {
+	GMATH_TRACE_ZONE("palette::compose");
+	for (size_t i = 0; i < a.count; i += 4) {
+		const size_t n = a.count - i < 4 ? a.count - i : 4;
+		(dualquat4::load(a, i, n) * dualquat4::load(b, i, n)).store(out, i, n);
+	}
+}
+
+void palette::compose(const dualquat_soa& a, const dualquat_soa& b, float* matrices, const bool& unit) {
+	GMATH_TRACE_ZONE("palette::compose");
+	for (size_t i = 0; i < a.count; i += 4) {
+		const size_t n = a.count - i < 4 ? a.count - i : 4;
+		storeMatrices(dualquat4::load(a, i, n) * dualquat4::load(b, i, n), matrices + 12 * i, n, unit);
+	}
+}
+
+void palette::relative(const dualquat_soa& a, const dualquat_soa& b, const dualquat_soa& out, const bool& unit) {
+	GMATH_TRACE_ZONE("palette::relative");
+	for (size_t i = 0; i < a.count; i += 4) {
+		const size_t n = a.count - i < 4 ? a.count - i : 4;
+		relativePose(dualquat4::load(a, i, n), dualquat4::load(b, i, n), unit).store(out, i, n);
+	}
+}
+
+void palette::relative(const dualquat_soa& a, const dualquat_soa& b, float* matrices, const bool& unit) {
+	GMATH_TRACE_ZONE("palette::relative");
+	for (size_t i = 0; i < a.count; i += 4) {
+		const size_t n = a.count - i < 4 ? a.count - i : 4;
+		storeMatrices(relativePose(dualquat4::load(a, i, n), dualquat4::load(b, i, n), unit), matrices + 12 * i, n, unit);
+	}
+}
+
+void palette::toMatrices(const dualquat_soa& d, float* matrices, const bool& unit) {
+	GMATH_TRACE_ZONE("palette::toMatrices");
+	for (size_t i = 0; i < d.count; i += 4) {
+		const size_t n = d.count - i < 4 ? d.count - i : 4;
+		storeMatrices(dualquat4::load(d, i, n), matrices + 12 * i, n, unit);
+	}
+}
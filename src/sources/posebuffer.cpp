@@ -0,0 +1,127 @@
+#include "..\include\gmath.hpp"
+
+#include <thread>
+
+using namespace gmath;
+
+// each slot starts on its own cache line so the writer and readers of different slots do not share lines
+static size_t slotFloats(const size_t& poseCount) {
+	return (8 * poseCount + 15) / 16 * 16;
+}
+
+poseBuffer::snapshot::snapshot(const poseBuffer* owner, const uint32_t& slot):
+	owner(owner), slot(slot) {
+}
+
+poseBuffer::snapshot::snapshot(snapshot&& other):
+	owner(other.owner), slot(other.slot) {
+	other.owner = nullptr;
+}
+
+poseBuffer::snapshot::~snapshot() {
+	if (owner != nullptr) {
+		owner->readers[slot].fetch_sub(1, std::memory_order_release);
+		owner = nullptr;
+	}
+}
+
+poseBuffer::snapshot& poseBuffer::snapshot::operator=(snapshot&& other) {
+	if (this != &other) {
+		if (owner != nullptr) {
+			owner->readers[slot].fetch_sub(1, std::memory_order_release);
+		}
+
+		owner = other.owner;
+		slot = other.slot;
+		other.owner = nullptr;
+	}
+
+	return *this;
+}
+
+dualquat_view poseBuffer::snapshot::operator[](const size_t& i) const {
+	return dualquat_view(owner->slotData(slot) + 8 * i);
+}
+
+dualquat_span poseBuffer::snapshot::poses() const {
+	return dualquat_span(owner->slotData(slot), owner->poseCount, 8 * sizeof(float));
+}
+
+uint64_t poseBuffer::snapshot::generation() const {
+	return owner->generations[slot];
+}
+
+poseBuffer::poseBuffer(const size_t& poseCount, const uint32_t& slots):
+	poseCount(poseCount),
+	slots(slots < 2 ? 2 : slots),
+	data(nullptr),
+	generations(nullptr),
+	readers(nullptr),
+	published(0),
+	writing(0),
+	nextGeneration(1) {
+	data = static_cast<float*>(_mm_malloc(this->slots * slotFloats(poseCount) * sizeof(float), 64));
+	generations = new uint64_t[this->slots];
+	readers = new std::atomic<uint32_t>[this->slots];
+
+	for (uint32_t s = 0; s < this->slots; s++) {
+		generations[s] = 0;
+		readers[s].store(0);
+
+		float* poses = slotData(s);
+		for (size_t i = 0; i < poseCount; i++) {
+			const float identity[8] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+			for (int c = 0; c < 8; c++) {
+				poses[8 * i + c] = identity[c];
+			}
+		}
+	}
+}
+
+poseBuffer::~poseBuffer() {
+	_mm_free(data);
+	delete[] generations;
+	delete[] readers;
+}
+
+dualquat_span poseBuffer::beginWrite() {
+	for (;;) {
+		const uint32_t current = published.load(std::memory_order_seq_cst);
+		for (uint32_t s = 0; s < slots; s++) {
+			// a reader that pins a slot after this check sees it is not published and lets go
+			if (s != current && readers[s].load(std::memory_order_seq_cst) == 0) {
+				writing = s;
+				return dualquat_span(slotData(s), poseCount, 8 * sizeof(float));
+			}
+		}
+
+		std::this_thread::yield();
+	}
+}
+
+void poseBuffer::publish() {
+	generations[writing] = nextGeneration++;
+	published.store(writing, std::memory_order_seq_cst);
+}
+
+poseBuffer::snapshot poseBuffer::read() const {
+	for (;;) {
+		const uint32_t slot = published.load(std::memory_order_seq_cst);
+		readers[slot].fetch_add(1, std::memory_order_seq_cst);
+
+		// the slot may have been unpublished and handed to the writer between the two steps above
+		if (published.load(std::memory_order_seq_cst) == slot) {
+			return snapshot(this, slot);
+		}
+
+		readers[slot].fetch_sub(1, std::memory_order_release);
+	}
+}
+
+size_t poseBuffer::size() const {
+	return poseCount;
+}
+
+float* poseBuffer::slotData(const uint32_t& slot) const {
+	return data + slot * slotFloats(poseCount);
+}
@@ -0,0 +1,316 @@
+#include "..\include\gmath.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace gmath;
+
+struct poseIndex::matches {
+	poseMatch* out;
+	uint32_t k;
+	uint32_t found;
+	// distance a pose has to beat to get in, infinite until k poses were found
+	float worst;
+
+	matches(poseMatch* out, const uint32_t& k): out(out), k(k), found(0), worst(INFINITY) {
+		for (uint32_t i = 0; i < k; i++) {
+			out[i] = poseMatch{ 0xffffffffu, INFINITY };
+		}
+	}
+
+	void insert(const uint32_t& index, const float& d) {
+		if (!(d < worst)) {
+			return;
+		}
+
+		uint32_t i = found < k ? found++ : k - 1;
+		while (i > 0 && out[i - 1].distance > d) {
+			out[i] = out[i - 1];
+			i--;
+		}
+		out[i] = poseMatch{ index, d };
+
+		if (found == k) {
+			worst = out[k - 1].distance;
+		}
+	}
+};
+
+// rotation then the translation t = 2 q r*, which is 7 floats
+static void toPoint(const dualquat_view& d, float* p) {
+	const float* r = d.data[0].data;
+	const float* q = d.data[1].data;
+
+	p[0] = r[0];
+	p[1] = r[1];
+	p[2] = r[2];
+	p[3] = r[3];
+	p[4] = 2.0f * (r[0] * q[1] - q[0] * r[1] + r[2] * q[3] - r[3] * q[2]);
+	p[5] = 2.0f * (r[0] * q[2] - q[0] * r[2] + r[3] * q[1] - r[1] * q[3]);
+	p[6] = 2.0f * (r[0] * q[3] - q[0] * r[3] + r[1] * q[2] - r[2] * q[1]);
+}
+
+static void broadcast(const float* p, __m128* out) {
+	for (uint32_t c = 0; c < 7; c++) {
+		out[c] = _mm_set1_ps(p[c]);
+	}
+}
+
+__m128 poseIndex::distance(const __m128* a, const __m128* b) const {
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+
+	// q and -q are the same rotation, so compare against whichever is on a's hemisphere
+	__m128 dot = _mm_mul_ps(a[0], b[0]);
+	for (uint32_t c = 1; c < 4; c++) {
+		dot = _mm_add_ps(dot, _mm_mul_ps(a[c], b[c]));
+	}
+	const __m128 flip = _mm_and_ps(dot, signMask);
+
+	// the chord |a - b| = 2 sin(angle / 4) keeps its precision for small angles where 2 acos(|dot|) does not
+	__m128 chord = _mm_setzero_ps();
+	for (uint32_t c = 0; c < 4; c++) {
+		const __m128 e = _mm_sub_ps(a[c], _mm_xor_ps(b[c], flip));
+		chord = _mm_add_ps(chord, _mm_mul_ps(e, e));
+	}
+	const __m128 half = _mm_min_ps(_mm_mul_ps(_mm_sqrt_ps(chord), _mm_set1_ps(0.5f)), _mm_set1_ps(1.0f));
+	const __m128 angle = _mm_mul_ps(trig::asin(half), _mm_set1_ps(4.0f));
+
+	__m128 gap = _mm_setzero_ps();
+	for (uint32_t c = 4; c < 7; c++) {
+		const __m128 e = _mm_sub_ps(a[c], b[c]);
+		gap = _mm_add_ps(gap, _mm_mul_ps(e, e));
+	}
+
+	return _mm_add_ps(
+		_mm_mul_ps(angle, _mm_set1_ps(metric.rotationWeight)),
+		_mm_mul_ps(_mm_sqrt_ps(gap), _mm_set1_ps(metric.translationWeight))
+	);
+}
+
+poseIndex::poseIndex(const dualquat_soa& poses, const poseMetric& metric, const uint32_t& leafSize):
+	metric(metric), leafSize(leafSize > 4 ? leafSize : 4), count(poses.count) {
+	// padded so leaf scans can always load four lanes
+	stride = (count + 7) & ~size_t(3);
+	data = static_cast<float*>(_mm_malloc(7 * stride * sizeof(float), 16));
+	indices = new uint32_t[count > 0 ? count : 1];
+	std::fill(data, data + 7 * stride, 0.0f);
+
+	std::vector<float> points(7 * count);
+	std::vector<poseMatch> order(count);
+	for (size_t i = 0; i < count; i++) {
+		float real[4] = { poses.data[0][i], poses.data[1][i], poses.data[2][i], poses.data[3][i] };
+		float dual[4] = { poses.data[4][i], poses.data[5][i], poses.data[6][i], poses.data[7][i] };
+		toPoint(dualquat_view(real, dual), &points[7 * i]);
+		order[i] = poseMatch{ static_cast<uint32_t>(i), 0.0f };
+	}
+
+	if (count > 0) {
+		uint32_t seed = 0x9e3779b9u;
+		build(0, static_cast<uint32_t>(count), points.data(), order.data(), seed);
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		indices[i] = order[i].index;
+		for (uint32_t c = 0; c < 7; c++) {
+			data[c * stride + i] = points[7 * order[i].index + c];
+		}
+	}
+}
+
+poseIndex::~poseIndex() {
+	_mm_free(data);
+	delete[] indices;
+}
+
+int32_t poseIndex::build(const uint32_t& begin, const uint32_t& end, const float* points, poseMatch* order, uint32_t& seed) {
+	const int32_t self = static_cast<int32_t>(nodes.size());
+	node n = {};
+	n.begin = begin;
+	n.middle = end;
+	n.end = end;
+	n.children[0] = -1;
+	n.children[1] = -1;
+	nodes.push_back(n);
+
+	if (end - begin <= leafSize) {
+		return self;
+	}
+
+	// a random vantage point keeps the splits balanced on clustered data without a sampling pass
+	seed = seed * 1664525u + 1013904223u;
+	std::swap(order[begin], order[begin + (seed >> 8) % (end - begin)]);
+	const float* vantage = points + 7 * order[begin].index;
+	__m128 v[7];
+	broadcast(vantage, v);
+
+	for (uint32_t i = begin; i < end; i += 4) {
+		__m128 p[7];
+		for (uint32_t c = 0; c < 7; c++) {
+			float lanes[4] = {};
+			for (uint32_t l = 0; l < 4 && i + l < end; l++) {
+				lanes[l] = points[7 * order[i + l].index + c];
+			}
+			p[c] = _mm_loadu_ps(lanes);
+		}
+
+		float d[4];
+		_mm_storeu_ps(d, distance(v, p));
+		for (uint32_t l = 0; l < 4 && i + l < end; l++) {
+			order[i + l].distance = d[l];
+		}
+	}
+	order[begin].distance = 0.0f;
+
+	const uint32_t middle = begin + (end - begin) / 2;
+	std::nth_element(order + begin, order + middle, order + end, [](const poseMatch& a, const poseMatch& b) {
+		return a.distance < b.distance;
+	});
+
+	float inner = 0.0f;
+	for (uint32_t i = begin; i < middle; i++) {
+		inner = std::max(inner, order[i].distance);
+	}
+	float outer = order[middle].distance;
+	for (uint32_t i = middle; i < end; i++) {
+		outer = std::min(outer, order[i].distance);
+	}
+
+	const int32_t left = build(begin, middle, points, order, seed);
+	const int32_t right = build(middle, end, points, order, seed);
+
+	node& split = nodes[self];
+	std::copy(vantage, vantage + 7, split.vantage);
+	split.inner = inner;
+	split.outer = outer;
+	split.middle = middle;
+	split.children[0] = left;
+	split.children[1] = right;
+	return self;
+}
+
+void poseIndex::scan(const uint32_t& begin, const uint32_t& end, const __m128* query, matches& best) const {
+	for (uint32_t i = begin; i < end; i += 4) {
+		__m128 p[7];
+		for (uint32_t c = 0; c < 7; c++) {
+			p[c] = _mm_loadu_ps(data + c * stride + i);
+		}
+
+		const __m128 d = distance(query, p);
+		int mask = _mm_movemask_ps(_mm_cmplt_ps(d, _mm_set1_ps(best.worst)));
+		if (end - i < 4) {
+			mask &= (1 << (end - i)) - 1;
+		}
+		if (mask == 0) {
+			continue;
+		}
+
+		float lanes[4];
+		_mm_storeu_ps(lanes, d);
+		for (uint32_t l = 0; l < 4; l++) {
+			if (mask & (1 << l)) {
+				best.insert(indices[i + l], lanes[l]);
+			}
+		}
+	}
+}
+
+void poseIndex::search(const int32_t& n, const __m128* query, matches& best, const float& scale) const {
+	const node& split = nodes[n];
+	if (split.children[0] < 0) {
+		scan(split.begin, split.end, query, best);
+		return;
+	}
+
+	__m128 v[7];
+	broadcast(split.vantage, v);
+	const float d = _mm_cvtss_f32(distance(query, v));
+
+	// triangle inequality: nothing inside is closer than d - inner, nothing outside closer than outer - d
+	const float bound[2] = { std::max(0.0f, d - split.inner), std::max(0.0f, split.outer - d) };
+	const uint32_t first = d < 0.5f * (split.inner + split.outer) ? 0 : 1;
+	for (uint32_t i = 0; i < 2; i++) {
+		const uint32_t side = i == 0 ? first : 1 - first;
+		if (bound[side] * scale < best.worst) {
+			search(split.children[side], query, best, scale);
+		}
+	}
+}
+
+size_t poseIndex::size() const {
+	return count;
+}
+
+float poseIndex::distance(const dualquat_view& a, const dualquat_view& b) const {
+	float pa[7];
+	float pb[7];
+	toPoint(a, pa);
+	toPoint(b, pb);
+
+	__m128 va[7];
+	__m128 vb[7];
+	broadcast(pa, va);
+	broadcast(pb, vb);
+	return _mm_cvtss_f32(distance(va, vb));
+}
+
+uint32_t poseIndex::bruteForce(const dualquat_view& query, const uint32_t& k, poseMatch* out) const {
+	matches best(out, k);
+	if (k == 0) {
+		return 0;
+	}
+
+	float p[7];
+	toPoint(query, p);
+	__m128 q[7];
+	broadcast(p, q);
+
+	scan(0, static_cast<uint32_t>(count), q, best);
+	return best.found;
+}
+
+uint32_t poseIndex::nearest(const dualquat_view& query, const uint32_t& k, poseMatch* out, const float& epsilon) const {
+	matches best(out, k);
+	if (k == 0 || count == 0) {
+		return 0;
+	}
+
+	float p[7];
+	toPoint(query, p);
+	__m128 q[7];
+	broadcast(p, q);
+
+	search(0, q, best, 1.0f + std::max(0.0f, epsilon));
+	return best.found;
+}
+
+void poseIndex::nearest(const dualquat_span& queries, const uint32_t& k, poseMatch* out, const float& epsilon, const uint32_t& threads) const {
+	GMATH_TRACE_ZONE("poseIndex::nearest");
+	const size_t chunk = 64;
+	const size_t chunks = (queries.size() + chunk - 1) / chunk;
+	size_t workerCount = threads != 0 ? threads : std::thread::hardware_concurrency();
+	workerCount = workerCount < chunks ? workerCount : chunks;
+	workerCount = workerCount > 0 ? workerCount : 1;
+
+	// queries near dense regions take longer, so threads take the next chunk as they finish
+	std::atomic<size_t> next(0);
+	const auto work = [&]() {
+		GMATH_TRACE_ZONE("poseIndex queries");
+		for (size_t c = next.fetch_add(1); c < chunks; c = next.fetch_add(1)) {
+			const size_t last = std::min(queries.size(), (c + 1) * chunk);
+			for (size_t i = c * chunk; i < last; i++) {
+				nearest(queries[i], k, out + k * i, epsilon);
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (size_t t = 1; t < workerCount; t++) {
+		workers.emplace_back(work);
+	}
+	work();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,277 @@
+#include "..\include\gmath.hpp"
+
+using namespace gmath;
+
+// smallest real component a snorm16 can hold without rounding to zero
+const float qtangent::defaultBias = 1.0f / 32767.0f;
+
+// makes the real component of each lane non negative and at least bias, keeping the
+// quaternions unit length, then negates the lanes set in reflected
+static quat4 finishLanes(const quat4& q, const __m128& reflected, const float& bias) {
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+	const __m128 flip = _mm_and_ps(q.data[0], signBit);
+	quat4 result{ { _mm_xor_ps(q.data[0], flip), _mm_xor_ps(q.data[1], flip), _mm_xor_ps(q.data[2], flip), _mm_xor_ps(q.data[3], flip) } };
+
+	const __m128 biasV = _mm_set1_ps(bias);
+	const __m128 small = _mm_cmplt_ps(result.data[0], biasV);
+	const __m128 xyz2 = _mm_add_ps(
+		_mm_add_ps(_mm_mul_ps(result.data[1], result.data[1]), _mm_mul_ps(result.data[2], result.data[2])),
+		_mm_mul_ps(result.data[3], result.data[3])
+	);
+	const __m128 scale = _mm_div_ps(_mm_set1_ps(sqrtf(1.0f - bias * bias)), _mm_sqrt_ps(xyz2));
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 k = _mm_or_ps(_mm_and_ps(small, scale), _mm_andnot_ps(small, one));
+	result.data[0] = _mm_or_ps(_mm_and_ps(small, biasV), _mm_andnot_ps(small, result.data[0]));
+	for (int c = 1; c < 4; c++) {
+		result.data[c] = _mm_mul_ps(result.data[c], k);
+	}
+
+	const __m128 negate = _mm_and_ps(reflected, signBit);
+	for (int c = 0; c < 4; c++) {
+		result.data[c] = _mm_xor_ps(result.data[c], negate);
+	}
+
+	return result;
+}
+
+// loads entries i to i + n - 1 of a quat span into lanes
+static quat4 loadLanes(const quat_span& q, const size_t& i, const size_t& n) {
+	__m128 lanes[4];
+	for (size_t k = 0; k < 4; k++) {
+		lanes[k] = k < n ? q[i + k].load() : _mm_set_ps(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+	_MM_TRANSPOSE4_PS(lanes[0], lanes[1], lanes[2], lanes[3]);
+
+	return quat4{ { lanes[0], lanes[1], lanes[2], lanes[3] } };
+}
+
+static void storeLanes(const quat4& q, const quat_span& out, const size_t& i, const size_t& n) {
+	__m128 lanes[4] = { q.data[0], q.data[1], q.data[2], q.data[3] };
+	_MM_TRANSPOSE4_PS(lanes[0], lanes[1], lanes[2], lanes[3]);
+	for (size_t k = 0; k < n; k++) {
+		out[i + k].store(lanes[k]);
+	}
+}
+
+// quaternion of the frame (t, b, n), returned with reflected set if the frame is mirrored
+static __m128 frameToQuat(const float* t, const float* b, const float* n, bool& reflected) {
+	const float cx = t[1] * b[2] - t[2] * b[1];
+	const float cy = t[2] * b[0] - t[0] * b[2];
+	const float cz = t[0] * b[1] - t[1] * b[0];
+	reflected = cx * n[0] + cy * n[1] + cz * n[2] < 0.0f;
+	const float sign = reflected ? -1.0f : 1.0f;
+
+	// columns t, sign * b, n of a rotation matrix
+	const float m00 = t[0], m10 = t[1], m20 = t[2];
+	const float m01 = sign * b[0], m11 = sign * b[1], m21 = sign * b[2];
+	const float m02 = n[0], m12 = n[1], m22 = n[2];
+
+	// Shepperd's method, pivoting on the largest diagonal term
+	float w, x, y, z;
+	const float trace = m00 + m11 + m22;
+	if (trace > 0.0f) {
+		const float s = 2.0f * sqrtf(trace + 1.0f);
+		w = 0.25f * s;
+		x = (m21 - m12) / s;
+		y = (m02 - m20) / s;
+		z = (m10 - m01) / s;
+	}
+	else if (m00 > m11 && m00 > m22) {
+		const float s = 2.0f * sqrtf(1.0f + m00 - m11 - m22);
+		w = (m21 - m12) / s;
+		x = 0.25f * s;
+		y = (m01 + m10) / s;
+		z = (m02 + m20) / s;
+	}
+	else if (m11 > m22) {
+		const float s = 2.0f * sqrtf(1.0f + m11 - m00 - m22);
+		w = (m02 - m20) / s;
+		x = (m01 + m10) / s;
+		y = 0.25f * s;
+		z = (m12 + m21) / s;
+	}
+	else {
+		const float s = 2.0f * sqrtf(1.0f + m22 - m00 - m11);
+		w = (m10 - m01) / s;
+		x = (m02 + m20) / s;
+		y = (m12 + m21) / s;
+		z = 0.25f * s;
+	}
+
+	const float nInv = 1.0f / sqrtf(w * w + x * x + y * y + z * z);
+	return _mm_mul_ps(_mm_set_ps(z, y, x, w), _mm_set1_ps(nInv));
+}
+
+static void encodeFrames(const float* const* t, const float* const* b, const float* const* n, const quat_span& out, const size_t& i, const size_t& count, const float& bias) {
+	__m128 lanes[4];
+	float reflected[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (size_t k = 0; k < 4; k++) {
+		bool r = false;
+		lanes[k] = k < count ? frameToQuat(t[k], b[k], n[k], r) : _mm_set_ps(0.0f, 0.0f, 0.0f, 1.0f);
+		reflected[k] = r ? 1.0f : 0.0f;
+	}
+	_MM_TRANSPOSE4_PS(lanes[0], lanes[1], lanes[2], lanes[3]);
+
+	const quat4 q{ { lanes[0], lanes[1], lanes[2], lanes[3] } };
+	const __m128 mask = _mm_cmpgt_ps(_mm_loadu_ps(reflected), _mm_setzero_ps());
+	storeLanes(finishLanes(q, mask, bias), out, i, count);
+}
+
+void qtangent::encode(const vec4_span& tangents, const vec4_span& bitangents, const vec4_span& normals, const quat_span& out, const float& bias) {
+	GMATH_TRACE_ZONE("qtangent::encode");
+	const size_t count = tangents.size();
+	for (size_t i = 0; i < count; i += 4) {
+		const size_t n = count - i < 4 ? count - i : 4;
+		const float* t[4];
+		const float* b[4];
+		const float* nrm[4];
+		for (size_t k = 0; k < n; k++) {
+			t[k] = tangents[i + k].data;
+			b[k] = bitangents[i + k].data;
+			nrm[k] = normals[i + k].data;
+		}
+
+		encodeFrames(t, b, nrm, out, i, n, bias);
+	}
+}
+
+void qtangent::encode(const mat* frames, const quat_span& out, const size_t& count, const float& bias) {
+	GMATH_TRACE_ZONE("qtangent::encode");
+	for (size_t i = 0; i < count; i += 4) {
+		const size_t n = count - i < 4 ? count - i : 4;
+		const float* t[4];
+		const float* b[4];
+		const float* nrm[4];
+		for (size_t k = 0; k < n; k++) {
+			t[k] = frames[i + k][0].data;
+			b[k] = frames[i + k][1].data;
+			nrm[k] = frames[i + k][2].data;
+		}
+
+		encodeFrames(t, b, nrm, out, i, n, bias);
+	}
+}
+
+void qtangent::decode(const quat_span& qtangents, const vec4_span& tangents, const vec4_span& bitangents, const vec4_span& normals) {
+	GMATH_TRACE_ZONE("qtangent::decode");
+	const size_t count = qtangents.size();
+	for (size_t i = 0; i < count; i += 4) {
+		const size_t n = count - i < 4 ? count - i : 4;
+		const quat4 q = loadLanes(qtangents, i, n);
+		const __m128 w = q.data[0], x = q.data[1], y = q.data[2], z = q.data[3];
+
+		// homogeneous form so snorm16 rounding does not need a normalize first
+		const __m128 s = _mm_div_ps(_mm_set1_ps(2.0f), q.norm2());
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+		const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+		const __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+		const __m128 flip = _mm_and_ps(w, _mm_set1_ps(-0.0f));
+
+		__m128 t[4] = {
+			_mm_sub_ps(one, _mm_mul_ps(s, _mm_add_ps(yy, zz))),
+			_mm_mul_ps(s, _mm_add_ps(xy, wz)),
+			_mm_mul_ps(s, _mm_sub_ps(xz, wy)),
+			_mm_setzero_ps()
+		};
+		__m128 b[4] = {
+			_mm_xor_ps(flip, _mm_mul_ps(s, _mm_sub_ps(xy, wz))),
+			_mm_xor_ps(flip, _mm_sub_ps(one, _mm_mul_ps(s, _mm_add_ps(xx, zz)))),
+			_mm_xor_ps(flip, _mm_mul_ps(s, _mm_add_ps(yz, wx))),
+			_mm_setzero_ps()
+		};
+		__m128 nrm[4] = {
+			_mm_mul_ps(s, _mm_add_ps(xz, wy)),
+			_mm_mul_ps(s, _mm_sub_ps(yz, wx)),
+			_mm_sub_ps(one, _mm_mul_ps(s, _mm_add_ps(xx, yy))),
+			_mm_setzero_ps()
+		};
+		_MM_TRANSPOSE4_PS(t[0], t[1], t[2], t[3]);
+		_MM_TRANSPOSE4_PS(b[0], b[1], b[2], b[3]);
+		_MM_TRANSPOSE4_PS(nrm[0], nrm[1], nrm[2], nrm[3]);
+
+		for (size_t k = 0; k < n; k++) {
+			tangents[i + k].store(t[k]);
+			bitangents[i + k].store(b[k]);
+			normals[i + k].store(nrm[k]);
+		}
+	}
+}
+
+void qtangent::pack(const quat_span& qtangents, int16_t* out) {
+	GMATH_TRACE_ZONE("qtangent::pack");
+	const __m128 scale = _mm_set1_ps(32767.0f);
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	for (size_t i = 0; i < qtangents.size(); i++) {
+		const __m128 q = _mm_max_ps(_mm_min_ps(qtangents[i].load(), one), _mm_sub_ps(_mm_setzero_ps(), one));
+		const __m128i values = _mm_cvtps_epi32(_mm_mul_ps(q, scale));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(out + 4 * i), _mm_packs_epi32(values, values));
+	}
+}
+
+void qtangent::unpack(const int16_t* packed, const quat_span& out) {
+	GMATH_TRACE_ZONE("qtangent::unpack");
+	const __m128 scale = _mm_set1_ps(1.0f / 32767.0f);
+
+	for (size_t i = 0; i < out.size(); i++) {
+		const __m128i values = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(packed + 4 * i));
+		// sign extend to 32 bits
+		const __m128i wide = _mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16);
+		out[i].store(_mm_mul_ps(_mm_cvtepi32_ps(wide), scale));
+	}
+}
+
+void qtangent::skin(
+	const quat_span& qtangents,
+	const uint32_t* joints,
+	const float* weights,
+	const uint32_t& influences,
+	const dualquat_soa& palette,
+	const quat_span& out,
+	const float& bias
+) {
+	GMATH_TRACE_ZONE("qtangent::skin");
+	const size_t count = qtangents.size();
+	const quat_soa rotations = palette.real();
+
+	for (size_t i = 0; i < count; i += 4) {
+		const size_t n = count - i < 4 ? count - i : 4;
+
+		// blend the joint rotations, flipping each onto the first joint's hemisphere
+		quat4 first;
+		quat4 blend{ { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() } };
+		for (uint32_t j = 0; j < influences; j++) {
+			float lanes[4][4] = {};
+			float w[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (size_t k = 0; k < n; k++) {
+				const size_t v = (i + k) * influences + j;
+				const uint32_t joint = joints[v];
+				for (int c = 0; c < 4; c++) {
+					lanes[c][k] = rotations.data[c][joint];
+				}
+				w[k] = weights != nullptr ? weights[v] : 1.0f;
+			}
+
+			const quat4 r{ { _mm_loadu_ps(lanes[0]), _mm_loadu_ps(lanes[1]), _mm_loadu_ps(lanes[2]), _mm_loadu_ps(lanes[3]) } };
+			if (j == 0) {
+				first = r;
+			}
+			const __m128 flip = _mm_and_ps(first.dot(r), _mm_set1_ps(-0.0f));
+			blend = blend + _mm_xor_ps(_mm_loadu_ps(w), flip) * r;
+		}
+
+		// padding lanes blended nothing, give them the identity so the normalize stays finite
+		const __m128 empty = _mm_cmpeq_ps(blend.norm2(), _mm_setzero_ps());
+		blend.data[0] = _mm_or_ps(blend.data[0], _mm_and_ps(empty, _mm_set1_ps(1.0f)));
+		blend = blend.normalize();
+
+		// rotate the unmirrored frame, then restore the mirror sign
+		const quat4 q = loadLanes(qtangents, i, n);
+		const __m128 reflected = _mm_cmplt_ps(q.data[0], _mm_setzero_ps());
+		const __m128 flip = _mm_and_ps(reflected, _mm_set1_ps(-0.0f));
+		const quat4 unmirrored{ { _mm_xor_ps(q.data[0], flip), _mm_xor_ps(q.data[1], flip), _mm_xor_ps(q.data[2], flip), _mm_xor_ps(q.data[3], flip) } };
+
+		storeLanes(finishLanes(blend * unmirrored, reflected, bias), out, i, n);
+	}
+}
\ No newline at end of file
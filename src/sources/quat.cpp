@@ -26,6 +26,11 @@ quat::quat(const quat& other):
 	data[3] = other.data[3];
 }
 
+quat::quat(const quat_view& other):
+	data(new float[4]) {
+	_mm_store_ps(this->data, other.load());
+}
+
 quat::quat(quat&& other):
 	data(nullptr) {
 	this->data = other.data;
@@ -101,17 +106,33 @@ vec4 quat::transform(const vec4& v, const vec4& t) const {
 	return v[3] == 0.0f ? this->transform(v) : t + this->transform(v);
 }
 
-std::string quat::toString() const {
-	return std::string("a: ") + std::to_string(data[0]) +
-		std::string(" b: ") + std::to_string(data[1]) +
-		std::string(" c: ") + std::to_string(data[2]) +
-		std::string(" d: ") + std::to_string(data[3]);
+vec4 quat::transform(const vec4_view& v) const {
+	return quat_view(*this).transform(v);
 }
 
-quat gmath::operator*(const quat& q1, const quat& q2) {
-	const __m128 q1Data = _mm_load_ps(q1.data);
-	const __m128 q2Data = _mm_load_ps(q2.data);
+void quat::transform(const vec4_span& in, const vec4_span& out) const {
+	GMATH_TRACE_ZONE("quat::transform");
+	// q v q^-1 is the rotation matrix of q / |q|
+	const quat q = this->normalize();
+	const float w = q[0], x = q[1], y = q[2], z = q[3];
+	const __m128 col1 = _mm_set_ps(0.0f, 2.0f * (x * z - w * y), 2.0f * (x * y + w * z), 1.0f - 2.0f * (y * y + z * z));
+	const __m128 col2 = _mm_set_ps(0.0f, 2.0f * (y * z + w * x), 1.0f - 2.0f * (x * x + z * z), 2.0f * (x * y - w * z));
+	const __m128 col3 = _mm_set_ps(0.0f, 1.0f - 2.0f * (x * x + y * y), 2.0f * (y * z - w * x), 2.0f * (x * z + w * y));
+	const __m128 wMask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+
+	for (size_t i = 0; i < in.size(); i++) {
+		const vec4_view src = in[i];
+		const __m128 v = src.load();
+		const __m128 r = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(col1, _mm_replicate_x_ps(v)), _mm_mul_ps(col2, _mm_replicate_y_ps(v))),
+			_mm_mul_ps(col3, _mm_replicate_z_ps(v))
+		);
+		// the w lane of r can be -0, so replace it rather than OR the input w into it
+		out[i].store(_mm_or_ps(_mm_andnot_ps(wMask, r), _mm_and_ps(wMask, v)));
+	}
+}
 
+__m128 quat::multiply(const __m128& q1Data, const __m128& q2Data) {
 	const __m128 aaaa = _mm_replicate_x_ps(q1Data);
 	const __m128 bbbb = _mm_replicate_y_ps(q1Data);
 	const __m128 cccc = _mm_replicate_z_ps(q1Data);
@@ -138,9 +159,18 @@ quat gmath::operator*(const quat& q1, const quat& q2) {
 	const __m128 val3 = _mm_set_ps(-prod3[1], prod3[0], prod3[3], -prod3[2]);
 	const __m128 val4 = _mm_set_ps(prod4[0], prod4[1], -prod4[2], -prod4[3]);
 
-	return quat(
-		_mm_add_ps(_mm_add_ps(_mm_add_ps(val1, val2), val3), val4)
-	);
+	return _mm_add_ps(_mm_add_ps(_mm_add_ps(val1, val2), val3), val4);
+}
+
+std::string quat::toString() const {
+	return std::string("a: ") + std::to_string(data[0]) +
+		std::string(" b: ") + std::to_string(data[1]) +
+		std::string(" c: ") + std::to_string(data[2]) +
+		std::string(" d: ") + std::to_string(data[3]);
+}
+
+quat gmath::operator*(const quat& q1, const quat& q2) {
+	return quat(quat::multiply(_mm_load_ps(q1.data), _mm_load_ps(q2.data)));
 }
 
 quat gmath::operator*(const float& s, const quat& q) {
@@ -173,4 +203,79 @@ quat gmath::operator-(const quat& q1, const quat& q2) {
 	const __m128 b = _mm_load_ps(q2.data);
 
 	return quat(_mm_sub_ps(a, b));
-}
\ No newline at end of file
+}
+
+// lanes past the end of a batch read from here so the tail can share the 4 wide path
+alignas(16) static const float zeroLane[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+void quat::fromAxisAngle(const vec4* axes, const float* radians, quat* out, const size_t& count, const trigAccuracy& accuracy) {
+	GMATH_TRACE_ZONE("quat::fromAxisAngle");
+	for (size_t i = 0; i < count; i += 4) {
+		const size_t n = count - i < 4 ? count - i : 4;
+
+		float half[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (size_t k = 0; k < n; k++) {
+			half[k] = 0.5f * radians[i + k];
+		}
+
+		__m128 s;
+		__m128 c;
+		trig::sincos(_mm_loadu_ps(half), s, c, accuracy);
+
+		// transpose the axes to x, y, z lanes
+		__m128 x = _mm_load_ps(axes[i].data);
+		__m128 y = _mm_load_ps(n > 1 ? axes[i + 1].data : zeroLane);
+		__m128 z = _mm_load_ps(n > 2 ? axes[i + 2].data : zeroLane);
+		__m128 w = _mm_load_ps(n > 3 ? axes[i + 3].data : zeroLane);
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+
+		// w now holds the real parts, x, y, z the imaginary parts
+		w = c;
+		x = _mm_mul_ps(x, s);
+		y = _mm_mul_ps(y, s);
+		z = _mm_mul_ps(z, s);
+		_MM_TRANSPOSE4_PS(w, x, y, z);
+
+		const __m128 lanes[4] = { w, x, y, z };
+		for (size_t k = 0; k < n; k++) {
+			_mm_store_ps(out[i + k].data, lanes[k]);
+		}
+	}
+}
+
+void quat::fromEuler(const vec4* angles, quat* out, const size_t& count, const trigAccuracy& accuracy) {
+	GMATH_TRACE_ZONE("quat::fromEuler");
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	for (size_t i = 0; i < count; i += 4) {
+		const size_t n = count - i < 4 ? count - i : 4;
+
+		__m128 x = _mm_load_ps(angles[i].data);
+		__m128 y = _mm_load_ps(n > 1 ? angles[i + 1].data : zeroLane);
+		__m128 z = _mm_load_ps(n > 2 ? angles[i + 2].data : zeroLane);
+		__m128 w = _mm_load_ps(n > 3 ? angles[i + 3].data : zeroLane);
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+
+		__m128 sx, cx, sy, cy, sz, cz;
+		trig::sincos(_mm_mul_ps(x, half), sx, cx, accuracy);
+		trig::sincos(_mm_mul_ps(y, half), sy, cy, accuracy);
+		trig::sincos(_mm_mul_ps(z, half), sz, cz, accuracy);
+
+		// expanded product qz * qy * qx
+		const __m128 cycz = _mm_mul_ps(cy, cz);
+		const __m128 sysz = _mm_mul_ps(sy, sz);
+		const __m128 sycz = _mm_mul_ps(sy, cz);
+		const __m128 cysz = _mm_mul_ps(cy, sz);
+
+		__m128 qw = _mm_add_ps(_mm_mul_ps(cx, cycz), _mm_mul_ps(sx, sysz));
+		__m128 qx = _mm_sub_ps(_mm_mul_ps(sx, cycz), _mm_mul_ps(cx, sysz));
+		__m128 qy = _mm_add_ps(_mm_mul_ps(cx, sycz), _mm_mul_ps(sx, cysz));
+		__m128 qz = _mm_sub_ps(_mm_mul_ps(cx, cysz), _mm_mul_ps(sx, sycz));
+		_MM_TRANSPOSE4_PS(qw, qx, qy, qz);
+
+		const __m128 lanes[4] = { qw, qx, qy, qz };
+		for (size_t k = 0; k < n; k++) {
+			_mm_store_ps(out[i + k].data, lanes[k]);
+		}
+	}
+}
@@ -0,0 +1,136 @@
+#include "..\include\gmath.hpp"
+
+using namespace gmath;
+
+// matrix of rotation r followed by translation t
+static mat rigidMat(const unit_quat& r, const vec4& t) {
+	const float w = r[0], x = r[1], y = r[2], z = r[3];
+
+	return mat(
+		vec4(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y)),
+		vec4(2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x)),
+		vec4(2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y)),
+		vec4(t[0], t[1], t[2], 1.0f)
+	);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														rotation
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+rigid<rotation_only>::rigid(const unit_quat& r):
+	r(r) {
+}
+
+rotation rigid<rotation_only>::inverse() const {
+	return rotation(r.inverse());
+}
+
+vec4 rigid<rotation_only>::transform(const vec4& v) const {
+	return r.transform(v);
+}
+
+dualquat rigid<rotation_only>::toDualquat() const {
+	return dualquat(r.toQuat());
+}
+
+mat rigid<rotation_only>::toMat() const {
+	return rigidMat(r, vec4());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														translation
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+rigid<translation_only>::rigid(const vec4& t):
+	t(t[0], t[1], t[2]) {
+}
+
+translation rigid<translation_only>::inverse() const {
+	return translation(-t);
+}
+
+vec4 rigid<translation_only>::transform(const vec4& v) const {
+	return v[3] == 0.0f ? v : v + t;
+}
+
+dualquat rigid<translation_only>::toDualquat() const {
+	return dualquat(quat(1.0f), 0.5f * quat(t));
+}
+
+mat rigid<translation_only>::toMat() const {
+	return mat::translate(t);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														rigid_motion
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+rigid<general_motion>::rigid(const unit_quat& r, const vec4& t):
+	r(r), t(t[0], t[1], t[2]) {
+}
+
+rigid<general_motion>::rigid(const rotation& other):
+	r(other.r), t() {
+}
+
+rigid<general_motion>::rigid(const translation& other):
+	r(), t(other.t) {
+}
+
+rigid<general_motion>::rigid(const unit_dualquat& d):
+	r(d.rotation()), t(d.translation()) {
+}
+
+rigid_motion rigid<general_motion>::inverse() const {
+	const unit_quat rInv = r.inverse();
+	return rigid_motion(rInv, -rInv.transform(t));
+}
+
+vec4 rigid<general_motion>::transform(const vec4& v) const {
+	return v[3] == 0.0f ? r.transform(v) : r.transform(v) + t;
+}
+
+dualquat rigid<general_motion>::toDualquat() const {
+	return dualquat(r.toQuat(), t);
+}
+
+mat rigid<general_motion>::toMat() const {
+	return rigidMat(r, t);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														composition
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+rotation gmath::operator*(const rotation& a, const rotation& b) {
+	return rotation(a.r * b.r);
+}
+
+translation gmath::operator*(const translation& a, const translation& b) {
+	return translation(a.t + b.t);
+}
+
+rigid_motion gmath::operator*(const rotation& a, const translation& b) {
+	return rigid_motion(a.r, a.r.transform(b.t));
+}
+
+rigid_motion gmath::operator*(const translation& a, const rotation& b) {
+	return rigid_motion(b.r, a.t);
+}
+
+rigid_motion gmath::operator*(const rigid_motion& a, const rotation& b) {
+	return rigid_motion(a.r * b.r, a.t);
+}
+
+rigid_motion gmath::operator*(const rotation& a, const rigid_motion& b) {
+	return rigid_motion(a.r * b.r, a.r.transform(b.t));
+}
+
+rigid_motion gmath::operator*(const rigid_motion& a, const translation& b) {
+	return rigid_motion(a.r, a.r.transform(b.t) + a.t);
+}
+
+rigid_motion gmath::operator*(const translation& a, const rigid_motion& b) {
+	return rigid_motion(b.r, b.t + a.t);
+}
+
+rigid_motion gmath::operator*(const rigid_motion& a, const rigid_motion& b) {
+	return rigid_motion(a.r * b.r, a.r.transform(b.t) + a.t);
+}
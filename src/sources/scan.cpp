@@ -0,0 +1,217 @@
+#include "..\include\gmath.hpp"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace gmath;
+
+// The scan is written once for quat and dualquat, these overloads are the only type specific parts
+
+static quat4 identity(const quat_soa&) {
+	return quat4{ { _mm_set1_ps(1.0f), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() } };
+}
+
+static dualquat4 identity(const dualquat_soa&) {
+	return dualquat4{ { identity(quat_soa()), quat4{ { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() } } } };
+}
+
+// loads entry index[k] into lane k, lanes with index[k] == end get the identity
+static quat4 gather(const quat_soa& q, const size_t* index, const size_t* end) {
+	quat4 result;
+	const float one[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+	for (int c = 0; c < 4; c++) {
+		float lanes[4];
+		for (int k = 0; k < 4; k++) {
+			lanes[k] = index[k] < end[k] ? q.data[c][index[k]] : one[c];
+		}
+		result.data[c] = _mm_loadu_ps(lanes);
+	}
+
+	return result;
+}
+
+static dualquat4 gather(const dualquat_soa& d, const size_t* index, const size_t* end) {
+	const quat4 dual = gather(d.dual(), index, end);
+	// the identity's dual part is zero, the real gather filled it with one
+	const __m128 active = _mm_castsi128_ps(_mm_set_epi32(
+		index[3] < end[3] ? -1 : 0, index[2] < end[2] ? -1 : 0, index[1] < end[1] ? -1 : 0, index[0] < end[0] ? -1 : 0
+	));
+
+	return dualquat4{ { gather(d.real(), index, end), quat4{ { _mm_and_ps(active, dual.data[0]), dual.data[1], dual.data[2], dual.data[3] } } } };
+}
+
+static void scatter(const quat4& q, const quat_soa& out, const size_t* index, const size_t* end) {
+	for (int c = 0; c < 4; c++) {
+		float lanes[4];
+		_mm_storeu_ps(lanes, q.data[c]);
+		for (int k = 0; k < 4; k++) {
+			if (index[k] < end[k]) {
+				out.data[c][index[k]] = lanes[k];
+			}
+		}
+	}
+}
+
+static void scatter(const dualquat4& d, const dualquat_soa& out, const size_t* index, const size_t* end) {
+	scatter(d.data[0], out.real(), index, end);
+	scatter(d.data[1], out.dual(), index, end);
+}
+
+// copies lane k into every lane
+static quat4 splat(const quat4& q, const int& k) {
+	float lanes[4];
+	quat4 result;
+	for (int c = 0; c < 4; c++) {
+		_mm_storeu_ps(lanes, q.data[c]);
+		result.data[c] = _mm_set1_ps(lanes[k]);
+	}
+
+	return result;
+}
+
+static dualquat4 splat(const dualquat4& d, const int& k) {
+	return dualquat4{ { splat(d.data[0], k), splat(d.data[1], k) } };
+}
+
+template <typename Reg, typename Soa>
+static void inclusiveScan(const Soa& in, const Soa& out, const scanOptions& options) {
+	const size_t count = in.count;
+	if (count == 0) {
+		return;
+	}
+
+	size_t threads = options.threads != 0 ? options.threads : std::thread::hardware_concurrency();
+	const size_t useful = count / (options.minEntriesPerThread > 0 ? options.minEntriesPerThread : 1);
+	threads = threads < useful ? threads : useful;
+	threads = threads > 0 ? threads : 1;
+
+	// each thread owns four sub-blocks, one per lane
+	const size_t blocks = 4 * threads;
+	const size_t blockSize = (count + blocks - 1) / blocks;
+	std::vector<size_t> begin(blocks + 1);
+	for (size_t b = 0; b <= blocks; b++) {
+		begin[b] = b * blockSize < count ? b * blockSize : count;
+	}
+
+	// products of each thread's four sub-blocks, lane k holding sub-block 4 t + k
+	std::vector<Reg> totals(threads);
+
+	// phase 1: scan every sub-block on its own
+	auto localScan = [&](const size_t t) {
+		GMATH_TRACE_ZONE("scan local block");
+		size_t index[4];
+		size_t end[4];
+		size_t length = 0;
+		for (int k = 0; k < 4; k++) {
+			index[k] = begin[4 * t + k];
+			end[k] = begin[4 * t + k + 1];
+			length = end[k] - index[k] > length ? end[k] - index[k] : length;
+		}
+
+		Reg acc = identity(in);
+		for (size_t j = 0; j < length; j++) {
+			acc = gather(in, index, end) * acc;
+			if (options.renormalizeEvery > 0 && (j + 1) % options.renormalizeEvery == 0) {
+				acc = acc.normalize();
+			}
+			scatter(acc, out, index, end);
+
+			for (int k = 0; k < 4; k++) {
+				index[k]++;
+			}
+		}
+
+		totals[t] = acc;
+	};
+
+	// phase 2: running product of the sub-block totals, prefix[b] covers sub-blocks 0 to b - 1
+	std::vector<Reg> prefix(blocks);
+
+	// phase 3: compose each entry with the product of every sub-block before it
+	auto fixUp = [&](const size_t t) {
+		GMATH_TRACE_ZONE("scan fix up");
+		for (size_t b = 4 * t; b < 4 * t + 4; b++) {
+			if (b == 0) {
+				continue;
+			}
+
+			for (size_t i = begin[b]; i < begin[b + 1]; i += 4) {
+				const size_t n = begin[b + 1] - i < 4 ? begin[b + 1] - i : 4;
+				(Reg::load(out, i, n) * prefix[b]).store(out, i, n);
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (size_t t = 1; t < threads; t++) {
+		workers.emplace_back(localScan, t);
+	}
+	localScan(0);
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	workers.clear();
+
+	Reg running = identity(in);
+	for (size_t b = 0; b < blocks; b++) {
+		prefix[b] = running;
+		running = splat(totals[b / 4], (int)(b % 4)) * running;
+		if (options.renormalizeEvery > 0) {
+			running = running.normalize();
+		}
+	}
+
+	for (size_t t = 1; t < threads; t++) {
+		workers.emplace_back(fixUp, t);
+	}
+	fixUp(0);
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+// shifts an inclusive scan one entry up and puts the identity first
+template <typename Soa>
+static void shiftToExclusive(const Soa& out) {
+	const size_t components = sizeof(out.data) / sizeof(out.data[0]);
+	for (size_t c = 0; c < components; c++) {
+		memmove(out.data[c] + 1, out.data[c], (out.count - 1) * sizeof(float));
+		out.data[c][0] = c == 0 ? 1.0f : 0.0f;
+	}
+}
+
+void scan::inclusive(const dualquat_soa& deltas, const dualquat_soa& poses, const scanOptions& options) {
+	GMATH_TRACE_ZONE("scan::inclusive");
+	inclusiveScan<dualquat4>(deltas, poses, options);
+}
+
+void scan::inclusive(const quat_soa& deltas, const quat_soa& poses, const scanOptions& options) {
+	GMATH_TRACE_ZONE("scan::inclusive");
+	inclusiveScan<quat4>(deltas, poses, options);
+}
+
+void scan::exclusive(const dualquat_soa& deltas, const dualquat_soa& poses, const scanOptions& options) {
+	GMATH_TRACE_ZONE("scan::exclusive");
+	if (deltas.count == 0) {
+		return;
+	}
+
+	// the last delta does not contribute to an exclusive scan
+	dualquat_soa head = deltas;
+	head.count--;
+	inclusiveScan<dualquat4>(head, poses, options);
+	shiftToExclusive(poses);
+}
+
+void scan::exclusive(const quat_soa& deltas, const quat_soa& poses, const scanOptions& options) {
+	GMATH_TRACE_ZONE("scan::exclusive");
+	if (deltas.count == 0) {
+		return;
+	}
+
+	quat_soa head = deltas;
+	head.count--;
+	inclusiveScan<quat4>(head, poses, options);
+	shiftToExclusive(poses);
+}
@@ -0,0 +1,274 @@
+#include "..\include\gmath.hpp"
+
+using namespace gmath;
+
+// the angle is reseeded with trig::sincos every this many groups of four samples, which keeps
+// the recurrence's rounding drift below about 1e-6
+static const size_t reseedEvery = 64;
+
+// (a0, a) * (b0, b) in double for the screw decomposition
+static void multiply(const double* a, const double* b, double* out) {
+	out[0] = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+	out[1] = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+	out[2] = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+	out[3] = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+}
+
+struct sweep::sampler {
+	const sweep& s;
+	size_t count;
+	size_t next;
+	float tStep;
+	dualquat4 from;
+	// cos and sin of half the screw angle of the four samples next to next + 3
+	__m128 c;
+	__m128 sn;
+	// rotates them on by four samples
+	__m128 cStep;
+	__m128 sStep;
+
+	sampler(const sweep& s, const size_t& count):
+		s(s), count(count), next(0), tStep(count > 1 ? 1.0f / static_cast<float>(count - 1) : 0.0f) {
+		for (uint32_t k = 0; k < 8; k++) {
+			from.data[k / 4].data[k % 4] = _mm_set1_ps(s.from[k]);
+		}
+
+		const float halfStep = 0.5f * s.theta * tStep;
+		cStep = _mm_set1_ps(cosf(4.0f * halfStep));
+		sStep = _mm_set1_ps(sinf(4.0f * halfStep));
+		seed();
+	}
+
+	__m128 times() const {
+		const float i = static_cast<float>(next);
+		return _mm_mul_ps(_mm_set_ps(i + 3.0f, i + 2.0f, i + 1.0f, i), _mm_set1_ps(tStep));
+	}
+
+	void seed() {
+		trig::sincos(_mm_mul_ps(times(), _mm_set1_ps(0.5f * s.theta)), sn, c);
+	}
+
+	// the next four sample poses
+	dualquat4 poses() {
+		const __m128 t = times();
+		dualquat4 d;
+
+		if (s.blend) {
+			const __m128 u = _mm_sub_ps(_mm_set1_ps(1.0f), t);
+			for (uint32_t k = 0; k < 8; k++) {
+				d.data[k / 4].data[k % 4] = _mm_mul_ps(t, _mm_set1_ps(s.delta[k]));
+			}
+			d.data[0].data[0] = _mm_add_ps(d.data[0].data[0], u);
+			d = d.normalize();
+		}
+		else {
+			// (from^-1 to)^t is a screw of t theta about the same axis with t times the pitch
+			const __m128 half = _mm_mul_ps(t, _mm_set1_ps(0.5f * s.pitch));
+			d.data[0].data[0] = c;
+			d.data[1].data[0] = _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(half, sn));
+			const __m128 hc = _mm_mul_ps(half, c);
+			for (uint32_t k = 0; k < 3; k++) {
+				const __m128 axis = _mm_set1_ps(s.axis[k]);
+				d.data[0].data[k + 1] = _mm_mul_ps(sn, axis);
+				d.data[1].data[k + 1] = _mm_add_ps(_mm_mul_ps(sn, _mm_set1_ps(s.moment[k])), _mm_mul_ps(hc, axis));
+			}
+		}
+
+		next += 4;
+		if ((next / 4) % reseedEvery == 0) {
+			seed();
+		}
+		else {
+			const __m128 rotated = _mm_sub_ps(_mm_mul_ps(c, cStep), _mm_mul_ps(sn, sStep));
+			sn = _mm_add_ps(_mm_mul_ps(sn, cStep), _mm_mul_ps(c, sStep));
+			c = rotated;
+		}
+
+		return from * d;
+	}
+};
+
+sweep::sweep(const dualquat& from, const dualquat& to):
+	theta(0.0f), pitch(0.0f), axis{ 0.0f, 0.0f, 0.0f }, moment{ 0.0f, 0.0f, 0.0f }, blend(true) {
+	double a[8];
+	double b[8];
+	double dot = 0.0;
+	for (uint32_t k = 0; k < 8; k++) {
+		this->from[k] = from[k / 4][k % 4];
+		a[k] = from[k / 4][k % 4];
+		b[k] = to[k / 4][k % 4];
+		dot += k < 4 ? a[k] * b[k] : 0.0;
+	}
+
+	// take the short way round, the real part of the delta is then non negative
+	for (uint32_t k = 0; k < 8; k++) {
+		b[k] = dot < 0.0 ? -b[k] : b[k];
+		a[k] = k % 4 == 0 ? a[k] : -a[k];
+	}
+
+	// from^-1 to, unit dual quaternions invert by conjugation
+	double r[4];
+	double d[4];
+	double cross[4];
+	multiply(a, b, r);
+	multiply(a, b + 4, d);
+	multiply(a + 4, b, cross);
+	for (uint32_t k = 0; k < 4; k++) {
+		d[k] += cross[k];
+		delta[k] = static_cast<float>(r[k]);
+		delta[k + 4] = static_cast<float>(d[k]);
+	}
+
+	const double s = sqrt(r[1] * r[1] + r[2] * r[2] + r[3] * r[3]);
+	theta = static_cast<float>(2.0 * atan2(s, r[0]));
+
+	// for tiny rotations the screw axis is ill defined and the blend is as good
+	if (s < 1e-4) {
+		// slide is the length of the translation
+		double t[4];
+		const double rc[4] = { r[0], -r[1], -r[2], -r[3] };
+		multiply(d, rc, t);
+		pitch = static_cast<float>(2.0 * sqrt(t[1] * t[1] + t[2] * t[2] + t[3] * t[3]));
+		return;
+	}
+
+	blend = false;
+	const double p = -2.0 * d[0] / s;
+	pitch = static_cast<float>(p);
+	for (uint32_t k = 0; k < 3; k++) {
+		const double l = r[k + 1] / s;
+		axis[k] = static_cast<float>(l);
+		moment[k] = static_cast<float>((d[k + 1] - 0.5 * p * r[0] * l) / s);
+	}
+}
+
+float sweep::angle() const {
+	return theta;
+}
+
+float sweep::slide() const {
+	return pitch;
+}
+
+dualquat sweep::at(const float& t) const {
+	const dualquat start(quat(from[0], from[1], from[2], from[3]), quat(from[4], from[5], from[6], from[7]));
+
+	if (blend) {
+		const float u = 1.0f - t;
+		const dualquat d(
+			quat(u + t * delta[0], t * delta[1], t * delta[2], t * delta[3]),
+			quat(t * delta[4], t * delta[5], t * delta[6], t * delta[7])
+		);
+		return start * d.normalize();
+	}
+
+	const float h = 0.5f * t * theta;
+	const float s = sinf(h);
+	const float c = cosf(h);
+	const float half = 0.5f * t * pitch;
+	return start * dualquat(
+		quat(c, s * axis[0], s * axis[1], s * axis[2]),
+		quat(
+			-half * s,
+			s * moment[0] + half * c * axis[0],
+			s * moment[1] + half * c * axis[1],
+			s * moment[2] + half * c * axis[2]
+		)
+	);
+}
+
+void sweep::sample(const dualquat_soa& out) const {
+	GMATH_TRACE_ZONE("sweep::sample");
+	sampler poses(*this, out.count);
+	for (size_t i = 0; i < out.count; i += 4) {
+		poses.poses().store(out, i, out.count - i < 4 ? out.count - i : 4);
+	}
+}
+
+void sweep::transform(const vec4_span& points, const size_t& samples, const vec4_span& out) const {
+	GMATH_TRACE_ZONE("sweep::transform");
+	sampler poses(*this, samples);
+	for (size_t i = 0; i < samples; i += 4) {
+		float lanes[8][4];
+		const dualquat4 d = poses.poses();
+		for (uint32_t k = 0; k < 8; k++) {
+			_mm_storeu_ps(lanes[k], d.data[k / 4].data[k % 4]);
+		}
+
+		for (size_t l = 0; l < 4 && i + l < samples; l++) {
+			const dualquat pose(
+				quat(lanes[0][l], lanes[1][l], lanes[2][l], lanes[3][l]),
+				quat(lanes[4][l], lanes[5][l], lanes[6][l], lanes[7][l])
+			);
+			pose.transform(points, out.subspan((i + l) * points.size(), points.size()));
+		}
+	}
+}
+
+void sweep::bounds(const float* center, const float* halfExtents, const size_t& samples, float* sweptCenter, float* sweptHalfExtents) const {
+	GMATH_TRACE_ZONE("sweep::bounds");
+	const size_t count = samples > 2 ? samples : 2;
+
+	// the box at every sample, moved and refit like bounds::transform
+	float lo[3] = { INFINITY, INFINITY, INFINITY };
+	float hi[3] = { -INFINITY, -INFINITY, -INFINITY };
+	sampler poses(*this, count);
+	for (size_t i = 0; i < count; i += 4) {
+		float lanes[8][4];
+		const dualquat4 d = poses.poses();
+		for (uint32_t k = 0; k < 8; k++) {
+			_mm_storeu_ps(lanes[k], d.data[k / 4].data[k % 4]);
+		}
+
+		for (size_t l = 0; l < 4 && i + l < count; l++) {
+			const float w = lanes[0][l], x = lanes[1][l], y = lanes[2][l], z = lanes[3][l];
+			const float m[3][3] = {
+				{ 1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y - w * z), 2.0f * (x * z + w * y) },
+				{ 2.0f * (x * y + w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z - w * x) },
+				{ 2.0f * (x * z - w * y), 2.0f * (y * z + w * x), 1.0f - 2.0f * (x * x + y * y) }
+			};
+			// t = 2 q r* = 2 (rw qv - qw rv + rv x qv)
+			const float qw = lanes[4][l], qx = lanes[5][l], qy = lanes[6][l], qz = lanes[7][l];
+			const float t[3] = {
+				2.0f * (w * qx - qw * x + y * qz - z * qy),
+				2.0f * (w * qy - qw * y + z * qx - x * qz),
+				2.0f * (w * qz - qw * z + x * qy - y * qx)
+			};
+
+			for (uint32_t k = 0; k < 3; k++) {
+				const float c = m[k][0] * center[0] + m[k][1] * center[1] + m[k][2] * center[2] + t[k];
+				const float e = fabsf(m[k][0]) * halfExtents[0] + fabsf(m[k][1]) * halfExtents[1] + fabsf(m[k][2]) * halfExtents[2];
+				lo[k] = fminf(lo[k], c - e);
+				hi[k] = fmaxf(hi[k], c + e);
+			}
+		}
+	}
+
+	// Every point moves on a helix about the screw axis, whose arc between two samples stays
+	// within the sagitta r (1 - cos(step / 2)) = 2 r sin(step / 4)^2 of the chord, r being its
+	// distance to the axis. Chords lie inside the box around the sampled boxes, so growing it by
+	// the largest sagitta covers the arcs.
+	const float corner = sqrtf(halfExtents[0] * halfExtents[0] + halfExtents[1] * halfExtents[1] + halfExtents[2] * halfExtents[2]);
+	float radius;
+	if (blend) {
+		// no usable axis, measure from the origin and add the slide to stay conservative
+		radius = sqrtf(center[0] * center[0] + center[1] * center[1] + center[2] * center[2]) + corner + pitch;
+	}
+	else {
+		// the point of the axis nearest the origin is axis x moment
+		const float p[3] = {
+			center[0] - (axis[1] * moment[2] - axis[2] * moment[1]),
+			center[1] - (axis[2] * moment[0] - axis[0] * moment[2]),
+			center[2] - (axis[0] * moment[1] - axis[1] * moment[0])
+		};
+		const float r[3] = { p[1] * axis[2] - p[2] * axis[1], p[2] * axis[0] - p[0] * axis[2], p[0] * axis[1] - p[1] * axis[0] };
+		radius = sqrtf(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]) + corner;
+	}
+	const float quarter = sinf(0.25f * theta / static_cast<float>(count - 1));
+	const float sagitta = 2.0f * radius * quarter * quarter;
+
+	for (uint32_t k = 0; k < 3; k++) {
+		sweptCenter[k] = 0.5f * (lo[k] + hi[k]);
+		sweptHalfExtents[k] = 0.5f * (hi[k] - lo[k]) + sagitta;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,226 @@
+#include "..\include\gmath.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+using namespace gmath;
+
+// One writer, the owning thread, and readers that copy under the registry lock. Slots are
+// seqlocks: the writer zeroes a slot's sequence, writes the fields and then sets the sequence to
+// the event's index + 1. A reader keeps a copy only when the sequence read before and after the
+// fields is that index + 1, so it never returns an event being written or one the writer lapped.
+// Fields are relaxed atomics, so the copy is race free without slowing the writer down.
+struct traceSlot {
+	std::atomic<uint64_t> sequence;
+	std::atomic<const char*> name;
+	std::atomic<uint64_t> begin;
+	std::atomic<uint64_t> end;
+	std::atomic<uint32_t> depth;
+};
+
+struct traceRing {
+	// index of the next event
+	std::atomic<uint64_t> head;
+	// events before this were cleared
+	std::atomic<uint64_t> floor;
+	uint32_t thread;
+	// no live thread writes to it, guarded by registryMutex
+	bool free;
+	traceSlot slots[trace::ringSize];
+};
+
+static std::atomic<bool> traceEnabled(false);
+static std::mutex registryMutex;
+
+static std::vector<std::unique_ptr<traceRing>>& registry() {
+	static std::vector<std::unique_ptr<traceRing>> rings;
+	return rings;
+}
+
+// batch entry points start threads on every call, so rings of finished threads are handed to
+// new ones instead of growing the registry without bound
+struct ringOwner {
+	traceRing* ring = nullptr;
+
+	~ringOwner() {
+		if (ring != nullptr) {
+			std::lock_guard<std::mutex> lock(registryMutex);
+			ring->free = true;
+		}
+	}
+};
+
+static thread_local ringOwner localRing;
+static thread_local uint32_t localDepth = 0;
+
+static traceRing* threadRing() {
+	if (localRing.ring == nullptr) {
+		std::lock_guard<std::mutex> lock(registryMutex);
+		for (const std::unique_ptr<traceRing>& ring : registry()) {
+			if (ring->free) {
+				localRing.ring = ring.get();
+				break;
+			}
+		}
+
+		if (localRing.ring == nullptr) {
+			std::unique_ptr<traceRing> ring(new traceRing());
+			ring->head.store(0);
+			ring->floor.store(0);
+			for (traceSlot& slot : ring->slots) {
+				slot.sequence.store(0);
+			}
+			ring->thread = static_cast<uint32_t>(registry().size());
+			localRing.ring = ring.get();
+			registry().push_back(std::move(ring));
+		}
+		localRing.ring->free = false;
+	}
+
+	return localRing.ring;
+}
+
+void trace::enable(const bool& on) {
+	traceEnabled.store(on, std::memory_order_relaxed);
+}
+
+bool trace::enabled() {
+	return traceEnabled.load(std::memory_order_relaxed);
+}
+
+uint64_t trace::now() {
+	static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+void trace::record(const char* name, const uint64_t& begin, const uint64_t& end, const uint32_t& depth) {
+	traceRing* ring = threadRing();
+	const uint64_t head = ring->head.load(std::memory_order_relaxed);
+	traceSlot& slot = ring->slots[head % ringSize];
+
+	slot.sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.name.store(name, std::memory_order_relaxed);
+	slot.begin.store(begin, std::memory_order_relaxed);
+	slot.end.store(end, std::memory_order_relaxed);
+	slot.depth.store(depth, std::memory_order_relaxed);
+	slot.sequence.store(head + 1, std::memory_order_release);
+	ring->head.store(head + 1, std::memory_order_release);
+}
+
+std::vector<traceEvent> trace::collect() {
+	std::vector<traceEvent> events;
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	for (const std::unique_ptr<traceRing>& ring : registry()) {
+		const uint64_t head = ring->head.load(std::memory_order_acquire);
+		const uint64_t floor = ring->floor.load(std::memory_order_relaxed);
+		uint64_t first = head > ringSize ? head - ringSize : 0;
+		first = first > floor ? first : floor;
+
+		for (uint64_t i = first; i < head; i++) {
+			const traceSlot& slot = ring->slots[i % ringSize];
+			const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+			const traceEvent e{
+				slot.name.load(std::memory_order_relaxed),
+				slot.begin.load(std::memory_order_relaxed),
+				slot.end.load(std::memory_order_relaxed),
+				ring->thread,
+				slot.depth.load(std::memory_order_relaxed)
+			};
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			// the writer lapped this slot or is writing it right now
+			if (before != i + 1 || slot.sequence.load(std::memory_order_relaxed) != i + 1) {
+				continue;
+			}
+			events.push_back(e);
+		}
+	}
+
+	std::sort(events.begin(), events.end(), [](const traceEvent& a, const traceEvent& b) {
+		return a.begin < b.begin || (a.begin == b.begin && a.depth < b.depth);
+	});
+	return events;
+}
+
+void trace::clear() {
+	std::lock_guard<std::mutex> lock(registryMutex);
+	for (const std::unique_ptr<traceRing>& ring : registry()) {
+		ring->floor.store(ring->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+	}
+}
+
+static void writeJsonString(std::ostringstream& out, const char* s) {
+	out << '"';
+	for (; *s != '\0'; s++) {
+		if (*s == '"' || *s == '\\') {
+			out << '\\' << *s;
+		}
+		else if (static_cast<unsigned char>(*s) < 0x20) {
+			out << ' ';
+		}
+		else {
+			out << *s;
+		}
+	}
+	out << '"';
+}
+
+std::string trace::toChromeJson(const std::vector<traceEvent>& events) {
+	std::ostringstream out;
+	out.setf(std::ios::fixed);
+	out.precision(3);
+
+	// timestamps are in microseconds, complete events ("X") carry their duration
+	out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	uint32_t threads = 0;
+	for (const traceEvent& e : events) {
+		threads = std::max(threads, e.thread + 1);
+	}
+	for (uint32_t t = 0; t < threads; t++) {
+		out << (t == 0 ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+			<< ",\"args\":{\"name\":\"gmath thread " << t << "\"}}";
+	}
+	for (size_t i = 0; i < events.size(); i++) {
+		const traceEvent& e = events[i];
+		out << (threads == 0 && i == 0 ? "\n" : ",\n") << "{\"name\":";
+		writeJsonString(out, e.name);
+		out << ",\"cat\":\"gmath\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread
+			<< ",\"ts\":" << e.begin / 1000.0 << ",\"dur\":" << (e.end - e.begin) / 1000.0 << "}";
+	}
+	out << "\n]}\n";
+
+	return out.str();
+}
+
+bool trace::exportChrome(const std::string& path) {
+	std::ofstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	file << toChromeJson(collect());
+	return static_cast<bool>(file);
+}
+
+traceZone::traceZone(const char* name):
+	name(nullptr), begin(0), depth(0) {
+	if (trace::enabled()) {
+		this->name = name;
+		depth = localDepth++;
+		begin = trace::now();
+	}
+}
+
+traceZone::~traceZone() {
+	if (name != nullptr) {
+		const uint64_t end = trace::now();
+		localDepth--;
+		trace::record(name, begin, end, depth);
+	}
+}
\ No newline at end of file
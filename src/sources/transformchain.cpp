@@ -0,0 +1,208 @@
+#include "..\include\gmath.hpp"
+
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+using namespace gmath;
+
+bool transformChain::step::operator==(const step& other) const {
+	return rotation == other.rotation &&
+		data[0] == other.data[0] && data[1] == other.data[1] && data[2] == other.data[2] && data[3] == other.data[3];
+}
+
+void transformChain::append(const step& s) {
+	// + 0.0f turns -0.0f into 0.0f so equal chains hash equal
+	step next = { { s.data[0] + 0.0f, s.data[1] + 0.0f, s.data[2] + 0.0f, s.data[3] + 0.0f }, s.rotation };
+	const bool identity = next.rotation ? next.data[3] == 0.0f : next.data[0] == 0.0f && next.data[1] == 0.0f && next.data[2] == 0.0f;
+	if (identity) {
+		return;
+	}
+
+	if (steps.empty() || steps.back().rotation != next.rotation) {
+		steps.push_back(next);
+		return;
+	}
+
+	step& last = steps.back();
+	if (!next.rotation) {
+		last.data[0] += next.data[0];
+		last.data[1] += next.data[1];
+		last.data[2] += next.data[2];
+		if (last.data[0] == 0.0f && last.data[1] == 0.0f && last.data[2] == 0.0f) {
+			steps.pop_back();
+		}
+		return;
+	}
+
+	// same axis or the opposite one
+	const bool same = last.data[0] == next.data[0] && last.data[1] == next.data[1] && last.data[2] == next.data[2];
+	const bool opposite = last.data[0] == -next.data[0] && last.data[1] == -next.data[1] && last.data[2] == -next.data[2];
+	if (!same && !opposite) {
+		steps.push_back(next);
+		return;
+	}
+
+	last.data[3] += same ? next.data[3] : -next.data[3];
+	if (last.data[3] == 0.0f) {
+		steps.pop_back();
+	}
+}
+
+transformChain& transformChain::translate(const vec4& t) {
+	append(step{ { t[0], t[1], t[2], 0.0f }, false });
+	return *this;
+}
+
+transformChain& transformChain::rotateX(const float& radians) {
+	append(step{ { 1.0f, 0.0f, 0.0f, radians }, true });
+	return *this;
+}
+
+transformChain& transformChain::rotateY(const float& radians) {
+	append(step{ { 0.0f, 1.0f, 0.0f, radians }, true });
+	return *this;
+}
+
+transformChain& transformChain::rotateZ(const float& radians) {
+	append(step{ { 0.0f, 0.0f, 1.0f, radians }, true });
+	return *this;
+}
+
+transformChain& transformChain::rotate(const vec4& axis, const float& radians) {
+	const float n = 1.0f / sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	append(step{ { axis[0] * n, axis[1] * n, axis[2] * n, radians }, true });
+	return *this;
+}
+
+transformChain& transformChain::euler(const vec4& radians) {
+	return rotateX(radians[0]).rotateY(radians[1]).rotateZ(radians[2]);
+}
+
+size_t transformChain::size() const {
+	return steps.size();
+}
+
+uint64_t transformChain::hash() const {
+	// FNV-1a over the kind and bits of every step
+	uint64_t h = 14695981039346656037ull;
+	const auto mix = [&h](const uint32_t& word) {
+		for (int b = 0; b < 4; b++) {
+			h ^= (word >> (8 * b)) & 0xff;
+			h *= 1099511628211ull;
+		}
+	};
+
+	for (const step& s : steps) {
+		mix(s.rotation ? 1 : 0);
+		for (int c = 0; c < 4; c++) {
+			uint32_t bits;
+			memcpy(&bits, &s.data[c], sizeof(bits));
+			mix(bits);
+		}
+	}
+
+	return h;
+}
+
+rigid_motion transformChain::toRigid() const {
+	rigid_motion result;
+	// consecutive rotations compose as quaternions and rotate the translation once
+	rotation run;
+	bool pending = false;
+
+	for (const step& s : steps) {
+		if (s.rotation) {
+			run = rotation(unit_quat::fromAxisAngle(vec4(s.data[0], s.data[1], s.data[2]), s.data[3])) * run;
+			pending = true;
+		}
+		else {
+			if (pending) {
+				result = run * result;
+				run = rotation();
+				pending = false;
+			}
+			result = translation(vec4(s.data[0], s.data[1], s.data[2])) * result;
+		}
+	}
+	if (pending) {
+		result = run * result;
+	}
+
+	return result;
+}
+
+dualquat transformChain::toDualquat() const {
+	return toRigid().toDualquat();
+}
+
+mat transformChain::toMat() const {
+	return toRigid().toMat();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														cache
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// chains are stored with their steps, flattened, so that a hash collision is never a wrong answer
+struct cachedChain {
+	std::vector<float> steps;
+	rigid_motion value;
+};
+
+static std::mutex cacheMutex;
+static std::unordered_multimap<uint64_t, cachedChain> cache;
+
+rigid_motion transformChain::cachedRigid() const {
+	std::vector<float> key;
+	key.reserve(5 * steps.size());
+	for (const step& s : steps) {
+		key.push_back(s.rotation ? 1.0f : 0.0f);
+		key.insert(key.end(), s.data, s.data + 4);
+	}
+
+	const uint64_t h = hash();
+	{
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		const auto range = cache.equal_range(h);
+		for (auto entry = range.first; entry != range.second; ++entry) {
+			if (entry->second.steps == key) {
+				return entry->second.value;
+			}
+		}
+	}
+
+	// collapse outside the lock, two threads racing on a new chain both compute the same value
+	const rigid_motion value = toRigid();
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	const auto range = cache.equal_range(h);
+	for (auto entry = range.first; entry != range.second; ++entry) {
+		if (entry->second.steps == key) {
+			return value;
+		}
+	}
+	// whole table eviction, a working set that fits refills it in one pass
+	if (cache.size() >= cacheCapacity) {
+		cache.clear();
+	}
+	cache.insert(std::make_pair(h, cachedChain{ key, value }));
+
+	return value;
+}
+
+dualquat transformChain::cachedDualquat() const {
+	return cachedRigid().toDualquat();
+}
+
+mat transformChain::cachedMat() const {
+	return cachedRigid().toMat();
+}
+
+size_t transformChain::cacheSize() {
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	return cache.size();
+}
+
+void transformChain::clearCache() {
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	cache.clear();
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "..\include\gmath.hpp"
+
+using namespace gmath;
+
+// Cody-Waite split of pi / 2, the first two parts have enough trailing zero
+// bits that j * part is exact for the range covered by the precise tier
+static const float PIO2_1 = 1.5703125f;
+static const float PIO2_2 = 4.837512969970703125e-4f;
+static const float PIO2_3 = 7.54978995489188216e-8f;
+static const float TWO_OVER_PI = 0.636619772367581343f;
+
+void trig::sincos(const __m128& x, __m128& s, __m128& c, const trigAccuracy& accuracy) {
+	// reduce to r in [-pi/4, pi/4] with x = j * pi/2 + r
+	const __m128i j = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(TWO_OVER_PI)));
+	const __m128 y = _mm_cvtepi32_ps(j);
+
+	__m128 r;
+	__m128 sinPoly;
+	__m128 cosPoly;
+	if (accuracy == trigAccuracy::precise) {
+		r = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(PIO2_1)));
+		r = _mm_sub_ps(r, _mm_mul_ps(y, _mm_set1_ps(PIO2_2)));
+		r = _mm_sub_ps(r, _mm_mul_ps(y, _mm_set1_ps(PIO2_3)));
+		const __m128 r2 = _mm_mul_ps(r, r);
+
+		// minimax polynomials from cephes sinf / cosf
+		sinPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.9515295891e-4f), r2), _mm_set1_ps(8.3321608736e-3f));
+		sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, r2), _mm_set1_ps(-1.6666654611e-1f));
+		sinPoly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sinPoly, r2), r), r);
+
+		cosPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.443315711809948e-5f), r2), _mm_set1_ps(-1.388731625493765e-3f));
+		cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, r2), _mm_set1_ps(4.166664568298827e-2f));
+		cosPoly = _mm_mul_ps(_mm_mul_ps(cosPoly, r2), r2);
+		cosPoly = _mm_add_ps(_mm_sub_ps(cosPoly, _mm_mul_ps(_mm_set1_ps(0.5f), r2)), _mm_set1_ps(1.0f));
+	}
+	else {
+		r = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(PIO2_1 + PIO2_2)));
+		const __m128 r2 = _mm_mul_ps(r, r);
+
+		// one term shorter on each side, truncation error stays below 4e-5 on [-pi/4, pi/4]
+		sinPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(8.3321608736e-3f), r2), _mm_set1_ps(-1.6666654611e-1f));
+		sinPoly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sinPoly, r2), r), r);
+
+		cosPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.388731625493765e-3f), r2), _mm_set1_ps(4.166664568298827e-2f));
+		cosPoly = _mm_mul_ps(_mm_mul_ps(cosPoly, r2), r2);
+		cosPoly = _mm_add_ps(_mm_sub_ps(cosPoly, _mm_mul_ps(_mm_set1_ps(0.5f), r2)), _mm_set1_ps(1.0f));
+	}
+
+	// odd quadrants swap sin and cos
+	const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+	const __m128 sinValue = _mm_or_ps(_mm_and_ps(swap, cosPoly), _mm_andnot_ps(swap, sinPoly));
+	const __m128 cosValue = _mm_or_ps(_mm_and_ps(swap, sinPoly), _mm_andnot_ps(swap, cosPoly));
+
+	// sin is negated in quadrants 2 and 3, cos in quadrants 1 and 2
+	const __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), 30));
+	const __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+
+	s = _mm_xor_ps(sinValue, sinSign);
+	c = _mm_xor_ps(cosValue, cosSign);
+}
+
+void trig::sincos(const float* x, float* s, float* c, const size_t& count, const trigAccuracy& accuracy) {
+	GMATH_TRACE_ZONE("trig::sincos");
+	size_t i = 0;
+	__m128 sv;
+	__m128 cv;
+
+	for (; i + 4 <= count; i += 4) {
+		trig::sincos(_mm_loadu_ps(x + i), sv, cv, accuracy);
+		_mm_storeu_ps(s + i, sv);
+		_mm_storeu_ps(c + i, cv);
+	}
+
+	if (i < count) {
+		float xs[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float ss[4];
+		float cs[4];
+		for (size_t k = 0; k < count - i; k++) {
+			xs[k] = x[i + k];
+		}
+
+		trig::sincos(_mm_loadu_ps(xs), sv, cv, accuracy);
+		_mm_storeu_ps(ss, sv);
+		_mm_storeu_ps(cs, cv);
+		for (size_t k = 0; k < count - i; k++) {
+			s[i + k] = ss[k];
+			c[i + k] = cs[k];
+		}
+	}
+}
+
+
+// asin of a in [0, 0.5] and the pieces shared with acos: for |x| > 0.5 the argument is
+// sqrt((1 - |x|) / 2), where asin(|x|) = pi / 2 - 2 asin(arg), to stay accurate near 1
+static __m128 asinReduced(const __m128& x, __m128& big) {
+	const __m128 a = _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+	big = _mm_cmpgt_ps(a, _mm_set1_ps(0.5f));
+	const __m128 zBig = _mm_mul_ps(_mm_set1_ps(0.5f), _mm_sub_ps(_mm_set1_ps(1.0f), a));
+	const __m128 z = _mm_or_ps(_mm_and_ps(big, zBig), _mm_andnot_ps(big, _mm_mul_ps(a, a)));
+	const __m128 s = _mm_or_ps(_mm_and_ps(big, _mm_sqrt_ps(zBig)), _mm_andnot_ps(big, a));
+
+	// minimax polynomial from cephes asinf
+	__m128 p = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(4.2163199048e-2f), z), _mm_set1_ps(2.4181311049e-2f));
+	p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(4.5470025998e-2f));
+	p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(7.4953002686e-2f));
+	p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(1.6666752422e-1f));
+	return _mm_add_ps(_mm_mul_ps(_mm_mul_ps(p, z), s), s);
+}
+
+__m128 trig::asin(const __m128& x) {
+	__m128 big;
+	const __m128 p = asinReduced(x, big);
+	const __m128 pBig = _mm_sub_ps(_mm_set1_ps(1.57079632679489661923f), _mm_add_ps(p, p));
+	const __m128 result = _mm_or_ps(_mm_and_ps(big, pBig), _mm_andnot_ps(big, p));
+	return _mm_xor_ps(result, _mm_and_ps(x, _mm_set1_ps(-0.0f)));
+}
+
+__m128 trig::acos(const __m128& x) {
+	__m128 big;
+	const __m128 p = asinReduced(x, big);
+	const __m128 negative = _mm_cmplt_ps(x, _mm_setzero_ps());
+
+	// |x| <= 0.5: pi / 2 - asin(x), x > 0.5: 2 asin(arg), x < -0.5: pi - 2 asin(arg)
+	const __m128 small = _mm_sub_ps(_mm_set1_ps(1.57079632679489661923f), _mm_xor_ps(p, _mm_and_ps(x, _mm_set1_ps(-0.0f))));
+	const __m128 twice = _mm_add_ps(p, p);
+	const __m128 large = _mm_or_ps(_mm_and_ps(negative, _mm_sub_ps(_mm_set1_ps(3.14159265358979323846f), twice)), _mm_andnot_ps(negative, twice));
+	return _mm_or_ps(_mm_and_ps(big, large), _mm_andnot_ps(big, small));
+}
\ No newline at end of file
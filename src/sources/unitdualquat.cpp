@@ -0,0 +1,85 @@
+#include "..\include\gmath.hpp"
+
+using namespace gmath;
+
+unit_dualquat::unit_dualquat():
+	dualquat(quat(1.0f)) {
+}
+
+unit_dualquat::unit_dualquat(const dualquat& d):
+	dualquat(d.normalize()) {
+}
+
+unit_dualquat::unit_dualquat(const unit_quat& r):
+	dualquat(r) {
+}
+
+unit_dualquat::unit_dualquat(const unit_quat& r, const vec4& t):
+	dualquat(r, t) {
+}
+
+unit_dualquat::unit_dualquat(const quat& real, const quat& dual, trusted):
+	dualquat(real, dual) {
+}
+
+unit_dualquat::unit_dualquat(const unit_dualquat& other):
+	dualquat(other) {
+}
+
+unit_dualquat::unit_dualquat(unit_dualquat&& other):
+	dualquat(std::move(other)) {
+}
+
+unit_dualquat& unit_dualquat::operator=(const unit_dualquat& other) {
+	dualquat::operator=(other);
+	return *this;
+}
+
+unit_dualquat& unit_dualquat::operator=(unit_dualquat&& other) {
+	dualquat::operator=(std::move(other));
+	return *this;
+}
+
+unit_dualquat unit_dualquat::conjugate() const {
+	return unit_dualquat(data[0].conjugate(), data[1].conjugate(), trusted());
+}
+
+unit_dualquat unit_dualquat::inverse() const {
+	return this->conjugate();
+}
+
+dualquat unit_dualquat::toDualquat() const {
+	return dualquat(*this);
+}
+
+vec4 unit_dualquat::transform(const vec4& v) const {
+	const __m128 r = _mm_load_ps(data[0].data);
+	const __m128 rotated = unit_quat::rotate(r, _mm_load_ps(v.data));
+	if (v[3] == 0.0f) {
+		return vec4(rotated);
+	}
+
+	// translation 2 d r*, the real lane is dropped by the shuffle
+	const __m128 t = quat::multiply(_mm_load_ps(data[1].data), _mm_xor_ps(r, _mm_set_ps(-0.0f, -0.0f, -0.0f, 0.0f)));
+	const __m128 txyz = _mm_and_ps(
+		_mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 3, 2, 1)),
+		_mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1))
+	);
+	return vec4(_mm_add_ps(rotated, _mm_add_ps(txyz, txyz)));
+}
+
+unit_quat unit_dualquat::rotation() const {
+	return unit_quat(_mm_load_ps(data[0].data), unit_quat::trusted());
+}
+
+vec4 unit_dualquat::translation() const {
+	const quat t = 2.0f * (data[1] * data[0].conjugate());
+	return vec4(t[1], t[2], t[3]);
+}
+
+unit_dualquat gmath::operator*(const unit_dualquat& d1, const unit_dualquat& d2) {
+	const quat ac = d1.data[0] * d2.data[0];
+	const quat ad = d1.data[0] * d2.data[1];
+	const quat bc = d1.data[1] * d2.data[0];
+	return unit_dualquat(ac, ad + bc, unit_dualquat::trusted());
+}
@@ -0,0 +1,91 @@
+#include "..\include\gmath.hpp"
+
+using namespace gmath;
+
+unit_quat::unit_quat():
+	quat(1.0f) {
+}
+
+unit_quat::unit_quat(const quat& q):
+	quat(q.normalize()) {
+}
+
+unit_quat::unit_quat(const __m128& q, trusted):
+	quat(q) {
+}
+
+unit_quat::unit_quat(const unit_quat& other):
+	quat(other) {
+}
+
+unit_quat::unit_quat(unit_quat&& other):
+	quat(std::move(other)) {
+}
+
+unit_quat& unit_quat::operator=(const unit_quat& other) {
+	quat::operator=(other);
+	return *this;
+}
+
+unit_quat& unit_quat::operator=(unit_quat&& other) {
+	quat::operator=(std::move(other));
+	return *this;
+}
+
+float unit_quat::operator[](const uint32_t& i) const {
+	return data[i];
+}
+
+unit_quat unit_quat::operator-() const {
+	return unit_quat(_mm_xor_ps(_mm_load_ps(data), _mm_set1_ps(-0.0f)), trusted());
+}
+
+unit_quat unit_quat::conjugate() const {
+	return unit_quat(_mm_xor_ps(_mm_load_ps(data), _mm_set_ps(-0.0f, -0.0f, -0.0f, 0.0f)), trusted());
+}
+
+unit_quat unit_quat::inverse() const {
+	return this->conjugate();
+}
+
+quat unit_quat::toQuat() const {
+	return quat(*this);
+}
+
+vec4 unit_quat::transform(const vec4& v) const {
+	return vec4(unit_quat::rotate(_mm_load_ps(data), _mm_load_ps(v.data)));
+}
+
+vec4 unit_quat::transform(const vec4& v, const vec4& t) const {
+	return v[3] == 0.0f ? this->transform(v) : t + this->transform(v);
+}
+
+unit_quat unit_quat::fromAxisAngle(const vec4& axis, const float& radians) {
+	const float COS = cosf(radians / 2.0f);
+	const float SIN = sinf(radians / 2.0f) / sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	return unit_quat(_mm_set_ps(SIN * axis[2], SIN * axis[1], SIN * axis[0], COS), trusted());
+}
+
+__m128 unit_quat::rotate(const __m128& q, const __m128& v) {
+	// v' = v + w t + u x t with t = 2 u x v, u the imaginary part of q
+	const __m128 u = _mm_shuffle_ps(q, q, _MM_SHUFFLE(0, 3, 2, 1));
+	const __m128 w = _mm_replicate_x_ps(q);
+
+	// the w lanes of both cross products cancel to zero, so v's w passes through
+	const __m128 uYZX = _mm_shuffle_ps(u, u, _MM_SHUFFLE(3, 0, 2, 1));
+	const __m128 uZXY = _mm_shuffle_ps(u, u, _MM_SHUFFLE(3, 1, 0, 2));
+	const __m128 vYZX = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 2, 1));
+	const __m128 vZXY = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 1, 0, 2));
+	const __m128 uCrossV = _mm_sub_ps(_mm_mul_ps(uYZX, vZXY), _mm_mul_ps(uZXY, vYZX));
+	const __m128 t = _mm_add_ps(uCrossV, uCrossV);
+
+	const __m128 tYZX = _mm_shuffle_ps(t, t, _MM_SHUFFLE(3, 0, 2, 1));
+	const __m128 tZXY = _mm_shuffle_ps(t, t, _MM_SHUFFLE(3, 1, 0, 2));
+	const __m128 uCrossT = _mm_sub_ps(_mm_mul_ps(uYZX, tZXY), _mm_mul_ps(uZXY, tYZX));
+
+	return _mm_add_ps(_mm_add_ps(v, _mm_mul_ps(w, t)), uCrossT);
+}
+
+unit_quat gmath::operator*(const unit_quat& q1, const unit_quat& q2) {
+	return unit_quat(quat::multiply(_mm_load_ps(q1.data), _mm_load_ps(q2.data)), unit_quat::trusted());
+}
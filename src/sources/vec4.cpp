@@ -19,6 +19,11 @@ vec4::vec4(const vec4& other):
 	data[3] = other.data[3];
 }
 
+vec4::vec4(const vec4_view& other):
+	data(new float[4]) {
+	_mm_store_ps(this->data, other.load());
+}
+
 vec4::vec4(vec4&& other):
 	data(nullptr) {
 	data = other.data;
@@ -0,0 +1,312 @@
+#include "..\include\gmath.hpp"
+
+using namespace gmath;
+
+static bool isAligned(const float* p) {
+	return (reinterpret_cast<uintptr_t>(p) & 15) == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														vec4_view
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+vec4_view::vec4_view(float* data):
+	data(data), aligned(isAligned(data)) {
+}
+
+vec4_view::vec4_view(const vec4& v):
+	data(v.data), aligned(isAligned(v.data)) {
+}
+
+vec4_view& vec4_view::operator=(const vec4_view& other) {
+	if (data != other.data) {
+		store(other.load());
+	}
+
+	return *this;
+}
+
+vec4_view& vec4_view::operator=(const vec4& other) {
+	return *this = vec4_view(other);
+}
+
+float& vec4_view::operator[](const uint32_t& i) const {
+	return data[i];
+}
+
+vec4 vec4_view::operator-() const {
+	return vec4(_mm_xor_ps(load(), _mm_set1_ps(-0.0)));
+}
+
+__m128 vec4_view::load() const {
+	return aligned ? _mm_load_ps(data) : _mm_loadu_ps(data);
+}
+
+void vec4_view::store(const __m128& v) const {
+	if (aligned) {
+		_mm_store_ps(data, v);
+	}
+	else {
+		_mm_storeu_ps(data, v);
+	}
+}
+
+float vec4_view::dot(const vec4_view& other) const {
+	float result[4];
+	_mm_storeu_ps(result, _mm_mul_ps(load(), other.load()));
+	return result[0] + result[1] + result[2] + result[3];
+}
+
+float vec4_view::magnitude() const {
+	return sqrt(this->magnitude2());
+}
+
+float vec4_view::magnitude2() const {
+	return this->dot(*this);
+}
+
+vec4 vec4_view::multiply(const vec4_view& other) const {
+	return (*this) * other;
+}
+
+vec4 vec4_view::normalize() const {
+	return *this / this->magnitude();
+}
+
+std::string vec4_view::toString() const {
+	return vec4(*this).toString();
+}
+
+vec4 gmath::operator*(const vec4_view& v1, const vec4_view& v2) {
+	return vec4(_mm_mul_ps(v1.load(), v2.load()));
+}
+
+vec4 gmath::operator*(const float& s, const vec4_view& v) {
+	return vec4(_mm_mul_ps(_mm_set_ps1(s), v.load()));
+}
+
+vec4 gmath::operator*(const vec4_view& v, const float& s) {
+	return vec4(_mm_mul_ps(v.load(), _mm_set_ps1(s)));
+}
+
+vec4 gmath::operator/(const vec4_view& v, const float& s) {
+	return (1.0f / s) * v;
+}
+
+vec4 gmath::operator+(const vec4_view& v1, const vec4_view& v2) {
+	return vec4(_mm_add_ps(v1.load(), v2.load()));
+}
+
+vec4 gmath::operator-(const vec4_view& v1, const vec4_view& v2) {
+	return vec4(_mm_sub_ps(v1.load(), v2.load()));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														quat_view
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+quat_view::quat_view(float* data):
+	data(data), aligned(isAligned(data)) {
+}
+
+quat_view::quat_view(const quat& q):
+	data(q.data), aligned(isAligned(q.data)) {
+}
+
+quat_view& quat_view::operator=(const quat_view& other) {
+	if (data != other.data) {
+		store(other.load());
+	}
+
+	return *this;
+}
+
+quat_view& quat_view::operator=(const quat& other) {
+	return *this = quat_view(other);
+}
+
+float& quat_view::operator[](const uint32_t& i) const {
+	return data[i];
+}
+
+quat quat_view::operator-() const {
+	return quat(_mm_xor_ps(load(), _mm_set1_ps(-0.0)));
+}
+
+__m128 quat_view::load() const {
+	return aligned ? _mm_load_ps(data) : _mm_loadu_ps(data);
+}
+
+void quat_view::store(const __m128& q) const {
+	if (aligned) {
+		_mm_store_ps(data, q);
+	}
+	else {
+		_mm_storeu_ps(data, q);
+	}
+}
+
+quat quat_view::conjugate() const {
+	return quat(_mm_xor_ps(load(), _mm_set_ps(-0.0f, -0.0f, -0.0f, 0.0f)));
+}
+
+float quat_view::norm() const {
+	return sqrt(
+		data[0] * data[0] + data[1] * data[1] +
+		data[2] * data[2] + data[3] * data[3]
+	);
+}
+
+quat quat_view::inverse() const {
+	const float v2 = data[0] * data[0] + data[1] * data[1] +
+		data[2] * data[2] + data[3] * data[3];
+	return this->conjugate() / v2;
+}
+
+quat quat_view::normalize() const {
+	return *this / this->norm();
+}
+
+vec4 quat_view::transform(const vec4_view& v) const {
+	const __m128 q = load();
+	const float v2 = data[0] * data[0] + data[1] * data[1] +
+		data[2] * data[2] + data[3] * data[3];
+	const __m128 qInv = _mm_mul_ps(
+		_mm_xor_ps(q, _mm_set_ps(-0.0f, -0.0f, -0.0f, 0.0f)),
+		_mm_set_ps1(1.0f / v2)
+	);
+
+	// move x, y, z into the imaginary lanes of a pure quaternion
+	const __m128 xyzw = v.load();
+	const __m128 p = _mm_shuffle_ps(
+		_mm_shuffle_ps(_mm_setzero_ps(), xyzw, _MM_SHUFFLE(0, 0, 0, 0)),
+		xyzw,
+		_MM_SHUFFLE(2, 1, 2, 0)
+	);
+
+	float r[4];
+	_mm_storeu_ps(r, quat::multiply(q, quat::multiply(p, qInv)));
+	return vec4(r[1], r[2], r[3], v.data[3]);
+}
+
+vec4 quat_view::transform(const vec4_view& v, const vec4_view& t) const {
+	return v[3] == 0.0f ? this->transform(v) : t + this->transform(v);
+}
+
+std::string quat_view::toString() const {
+	return quat(*this).toString();
+}
+
+quat gmath::operator*(const quat_view& q1, const quat_view& q2) {
+	return quat(quat::multiply(q1.load(), q2.load()));
+}
+
+quat gmath::operator*(const float& s, const quat_view& q) {
+	return quat(_mm_mul_ps(_mm_set_ps1(s), q.load()));
+}
+
+quat gmath::operator*(const quat_view& q, const float& s) {
+	return quat(_mm_mul_ps(q.load(), _mm_set_ps1(s)));
+}
+
+quat gmath::operator/(const quat_view& q, const float& s) {
+	return (1.0f / s) * q;
+}
+
+quat gmath::operator+(const quat_view& q1, const quat_view& q2) {
+	return quat(_mm_add_ps(q1.load(), q2.load()));
+}
+
+quat gmath::operator-(const quat_view& q1, const quat_view& q2) {
+	return quat(_mm_sub_ps(q1.load(), q2.load()));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														dualquat_view
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+dualquat_view::dualquat_view(float* data):
+	data{ quat_view(data), quat_view(data + 4) } {
+}
+
+dualquat_view::dualquat_view(float* real, float* dual):
+	data{ quat_view(real), quat_view(dual) } {
+}
+
+dualquat_view::dualquat_view(const dualquat& d):
+	data{ quat_view(d.data[0]), quat_view(d.data[1]) } {
+}
+
+dualquat_view& dualquat_view::operator=(const dualquat_view& other) {
+	data[0] = other.data[0];
+	data[1] = other.data[1];
+
+	return *this;
+}
+
+dualquat_view& dualquat_view::operator=(const dualquat& other) {
+	return *this = dualquat_view(other);
+}
+
+quat_view dualquat_view::operator[](const uint32_t i) const {
+	return data[i];
+}
+
+dualquat dualquat_view::conjugate() const {
+	return dualquat(data[0].conjugate(), data[1].conjugate());
+}
+
+dualquat dualquat_view::dualConjugate() const {
+	return dualquat(data[0].conjugate(), -data[1].conjugate());
+}
+
+dualquat dualquat_view::inverse() const {
+	const quat pInv = data[0].inverse();
+
+	return dualquat(pInv, -1.0f * (pInv * (data[1] * pInv)));
+}
+
+dualquat dualquat_view::normalize() const {
+	return dualquat(*this).normalize();
+}
+
+vec4 dualquat_view::transform(const vec4_view& v) const {
+	// for a unit dual quaternion (r, d) this is r v r* + 2 d r*, translating only points
+	const vec4 rotated = data[0].transform(v);
+	if (v[3] == 0.0f) {
+		return rotated;
+	}
+
+	float t[4];
+	_mm_storeu_ps(t, quat::multiply(data[1].load(), _mm_xor_ps(data[0].load(), _mm_set_ps(-0.0f, -0.0f, -0.0f, 0.0f))));
+	return vec4(
+		rotated[0] + 2.0f * t[1],
+		rotated[1] + 2.0f * t[2],
+		rotated[2] + 2.0f * t[3],
+		v.data[3]
+	);
+}
+
+std::string dualquat_view::toString() const {
+	return dualquat(*this).toString();
+}
+
+dualquat gmath::operator*(const dualquat_view& d1, const dualquat_view& d2) {
+	const quat ac = d1.data[0] * d2.data[0];
+	const quat ad = d1.data[0] * d2.data[1];
+	const quat bc = d1.data[1] * d2.data[0];
+	return dualquat(ac, ad + bc);
+}
+
+dualquat gmath::operator*(const float& s, const dualquat_view& d) {
+	return dualquat(s * d.data[0], s * d.data[1]);
+}
+
+dualquat gmath::operator*(const dualquat_view& d, const float& s) {
+	return dualquat(d.data[0] * s, d.data[1] * s);
+}
+
+dualquat gmath::operator+(const dualquat_view& d1, const dualquat_view& d2) {
+	return dualquat(d1.data[0] + d2.data[0], d1.data[1] + d2.data[1]);
+}
+
+dualquat gmath::operator-(const dualquat_view& d1, const dualquat_view& d2) {
+	return dualquat(d1.data[0] - d2.data[0], d1.data[1] - d2.data[1]);
+}